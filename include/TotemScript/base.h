@@ -239,6 +239,7 @@ extern "C" {
     void totemInstruction_PrintAbcInstruction(FILE *file, totemInstruction instruction);
     void totemInstruction_PrintAbxInstruction(FILE *file, totemInstruction instruction);
     void totemInstruction_PrintAxxInstruction(FILE *file, totemInstruction instruction);
+    void totemInstruction_PrintNextExtension(FILE *file, totemInstruction instruction);
     
 #define TOTEM_INSTRUCTION_MASK_REGISTERA TOTEM_BITMASK(totemInstruction, totemInstructionStart_A, totemInstructionSize_A)
 #define TOTEM_INSTRUCTION_MASK_REGISTERA_SCOPE TOTEM_BITMASK(totemInstruction, totemInstructionStart_A, 1)
@@ -311,13 +312,108 @@ TOTEM_BITMASK(totemInstruction, 0, totemInstructionSize_Cx - 1))
     void *totem_CacheMalloc(size_t len);
     void totem_CacheFree(void *ptr, size_t len);
     
+    /**
+     * Returns objects cached by the calling thread to the global free-lists - also done automatically when a thread exits
+     */
+    void totem_FlushThreadCache();
+    
+    /**
+     * Returns completely free size-class pages to the system, returns number of bytes released
+     */
+    size_t totem_TrimMemory();
+    
+    /**
+     * Register stacks & gc register blocks - served from huge-page arenas when TOTEM_MEMOPT_HUGEPAGES is enabled
+     */
+    void *totem_LargeMalloc(size_t len);
+    void totem_LargeFree(void *ptr, size_t len);
+    
+    typedef struct
+    {
+        size_t ObjectSize;
+        size_t NumPages;
+        size_t NumLiveObjects;
+        size_t NumCachedObjects;
+        size_t NumFreeObjects;
+        size_t PeakLiveObjects;
+        size_t NumLockContentions;
+    }
+    totemMemorySizeClassStats;
+    
+    typedef struct
+    {
+        size_t PageSize;
+        size_t NumSizeClasses;
+        size_t NumPages;
+        size_t NumLargeAllocations;
+        size_t NumLargeBytes;
+        size_t PeakLargeBytes;
+        size_t TotalLargeAllocations;
+    }
+    totemMemoryStats;
+    
+    /**
+     * Objects sitting in thread caches are counted as cached, rather than live or free
+     */
+    void totem_GetMemoryStats(totemMemoryStats *stats);
+    totemBool totem_GetSizeClassStats(size_t index, totemMemorySizeClassStats *stats);
+    void totem_PrintMemoryStats(FILE *file);
+    
     void totem_printBits(FILE *file, uint64_t data, uint64_t numBits, uint64_t start);
     totemBool totem_getcwd(char *buffer, size_t size);
     
     totemHash totem_Hash(const void *data, size_t len);
+    totemHash totem_DefaultHash(const void *data, size_t len);
+    
+#define TOTEM_INTCHARS_MAXLENGTH (20)
+#define TOTEM_FLOATCHARS_MAXLENGTH (32)
+    
+    /**
+     * Decimal digits of val, with no terminator - returns the number of chars written
+     */
+    size_t totem_IntToChars(char *buffer, int64_t val);
+    
+    /**
+     * Shortest decimal that reads back as exactly val, laid out as javascript's Number.prototype.toString does (1.5, 100, 1e+21, 1e-7), with nan & inf spelled as printf does
+     * No terminator - returns the number of chars written
+     */
+    size_t totem_FloatToChars(char *buffer, double val);
+    
     void totem_SetMemoryCallbacks(totemMallocCb malloc, totemFreeCb free);
+    
+    /**
+     * Replaces the hash used for interned strings, object keys & lookups - NULL restores totem_DefaultHash
+     * Must be set before anything is hashed, as existing tables are not rehashed
+     */
     void totem_SetHashCallback(totemHashCb hash);
     
+    struct totemAllocator;
+    typedef void *(*totemAllocatorAllocCb)(struct totemAllocator *allocator, size_t size);
+    typedef void (*totemAllocatorFreeCb)(struct totemAllocator *allocator, void *ptr, size_t size);
+    typedef void *(*totemAllocatorReallocCb)(struct totemAllocator *allocator, void *ptr, size_t oldSize, size_t newSize);
+    
+    /**
+     * Per-tenant heap - Free always receives the size originally requested, Realloc may be NULL
+     * Byte counts are maintained by the totemAllocator_* wrappers and are not synchronised, an allocator must only be used by one thread at a time
+     */
+    typedef struct totemAllocator
+    {
+        totemAllocatorAllocCb Alloc;
+        totemAllocatorFreeCb Free;
+        totemAllocatorReallocCb Realloc;
+        void *Userdata;
+        size_t NumBytes;
+        size_t PeakBytes;
+        size_t NumAllocations;
+    }
+    totemAllocator;
+    
+    void totemAllocator_InitDefault(totemAllocator *allocator);
+    void totemAllocator_ResetStats(totemAllocator *allocator);
+    void *totemAllocator_Alloc(totemAllocator *allocator, size_t size);
+    void totemAllocator_Free(totemAllocator *allocator, void *ptr, size_t size);
+    void *totemAllocator_Realloc(totemAllocator *allocator, void *ptr, size_t oldSize, size_t newSize);
+    
     typedef struct
     {
         char *Data;
@@ -354,22 +450,48 @@ TOTEM_BITMASK(totemInstruction, 0, totemInstructionSize_Cx - 1))
     void *totemMemoryBlock_Alloc(totemMemoryBlock **blockHead, size_t objectSize);
     void totemMemoryBlock_Cleanup(totemMemoryBlock **blockHead);
     
+#define TOTEM_HASHMAP_INLINEKEYSIZE (16)
+    
     typedef struct totemHashMapEntry
     {
         const void *Key;
         size_t KeyLen;
         totemHash Hash;
         totemHashValue Value;
-        struct totemHashMapEntry *Next;
+        
+        // keys up to TOTEM_HASHMAP_INLINEKEYSIZE bytes are stored here rather than allocated, and Key points at them
+        char InlineKey[TOTEM_HASHMAP_INLINEKEYSIZE];
     }
     totemHashMapEntry;
     
     typedef struct
     {
-        totemHashMapEntry **Buckets;
-        totemHashMapEntry *FreeList;
-        size_t NumBuckets;
+        totemHashMapEntry *Entries;
+        int8_t *Controls;
+        size_t Capacity;
+        size_t GrowthLeft;
+    }
+    totemHashMapTable;
+    
+    /**
+     * Open-addressing hash map
+     * - entries live inline in a power-of-two slot array, along with short keys
+     * - each slot has a control byte holding either the low 7 bits of its hash, or an empty/deleted marker
+     * - lookups probe a group of control bytes at a time (16 with SSE2, 8 otherwise) before touching any entries
+     * - resizing is incremental: the previous table is kept in Old and drained a few slots per insert, lookups & removals check both
+     * - values of removed keys are kept on a freelist, and handed back out by the next insert
+     */
+    typedef struct
+    {
+        totemHashMapTable Table;
+        totemHashMapTable Old;
+        size_t MigrateIndex;
+        size_t MigrateStep;
+        totemHashValue *FreeValues;
         size_t NumKeys;
+        size_t NumFreeValues;
+        size_t MaxFreeValues;
+        totemAllocator *Allocator;
     }
     totemHashMap;
     
@@ -385,6 +507,17 @@ TOTEM_BITMASK(totemInstruction, 0, totemInstructionSize_Cx - 1))
     totemHashMapEntry *totemHashMap_Find(totemHashMap *hashmap, const void *key, size_t keyLen);
     totemHashMapEntry *totemHashMap_FindPrecomputed(totemHashMap *hashmap, const void *key, size_t keyLen, totemHash hash);
     
+    /**
+     * Returns the next live entry at or after *index, advancing it past the returned slot
+     * Removing the returned entry is safe mid-iteration, inserting is not
+     */
+    totemHashMapEntry *totemHashMap_Iterate(totemHashMap *hashmap, size_t *index);
+    
+    /**
+     * Value the next insert will take off the freelist, if any - lets callers recycle values of removed keys
+     */
+    totemBool totemHashMap_PeekFreeValue(totemHashMap *hashmap, totemHashValue *valueOut);
+    
     void totem_Init();
     void totem_InitMemory();
     
@@ -33,7 +33,8 @@ extern "C" {
         totemEvalStatus_TooManyScriptFunctions,
         totemEvalStatus_TooManyFunctionArguments,
         totemEvalStatus_InvalidDataType,
-        totemEvalStatus_InvalidShiftSource
+        totemEvalStatus_InvalidShiftSource,
+        totemEvalStatus_StructFieldNotDefined
     }
     totemEvalStatus;
     
@@ -79,6 +80,7 @@ extern "C" {
             totemBool Boolean;
         };
         size_t RefCount;
+        totemStructDeclarationPrototype *Struct;
         totemOperandXUnsigned GlobalCache;
         totemPublicDataType DataType;
         totemRegisterPrototypeFlag Flags;
@@ -130,6 +132,8 @@ extern "C" {
     totemBool totemRegisterListPrototype_GetRegisterFlags(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemRegisterPrototypeFlag *flags);
     totemBool totemRegisterListPrototype_GetRegisterType(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemPublicDataType *type);
     totemBool totemRegisterListPrototype_SetRegisterType(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemPublicDataType type);
+    totemBool totemRegisterListPrototype_GetRegisterStruct(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemStructDeclarationPrototype **dec);
+    totemBool totemRegisterListPrototype_SetRegisterStruct(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemStructDeclarationPrototype *dec);
     totemBool totemRegisterListPrototype_SetRegisterGlobalCache(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemOperandXUnsigned assoc);
     totemBool totemRegisterListPrototype_GetRegisterGlobalCache(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemOperandXUnsigned *assoc);
     
@@ -140,6 +144,7 @@ extern "C" {
     totemEvalStatus totemRegisterListPrototype_AddType(totemRegisterListPrototype *list, totemPublicDataType type, totemOperandRegisterPrototype *op);
     totemEvalStatus totemRegisterListPrototype_AddBoolean(totemRegisterListPrototype *list, totemBool val, totemOperandRegisterPrototype *op);
     totemEvalStatus totemRegisterListPrototype_AddNull(totemRegisterListPrototype *list, totemOperandRegisterPrototype *op);
+    totemEvalStatus totemRegisterListPrototype_AddTemplate(totemRegisterListPrototype *list, totemPublicDataType type, totemOperandRegisterPrototype *op);
     
     totemBool totemRegisterListPrototype_GetVariable(totemRegisterListPrototype *list, totemString *name, totemOperandRegisterPrototype *operand, totemBool currentOnly);
     totemBool totemRegisterListPrototype_GetIdentifier(totemRegisterListPrototype *list, totemString *name, totemOperandRegisterPrototype *operand, totemBool currentOnly);
@@ -160,16 +165,33 @@ extern "C" {
     }
     totemScriptFunctionPrototype;
     
+    /**
+     * Array & object literals are built once per instance from their constant parts, then cloned wherever they're evaluated
+     * - Values holds the global register of each constant value, or of null where a value is filled in afterwards
+     * - objects store key & value registers alternately
+     */
+    typedef struct
+    {
+        size_t ValuesStart;
+        size_t NumValues;
+        totemOperandXUnsigned Register;
+        totemPublicDataType Type;
+    }
+    totemTemplatePrototype;
+    
     typedef struct
     {
         totemRegisterListPrototype GlobalRegisters;
         totemHashMap FunctionLookup;
+        totemHashMap StructLookup;
         totemMemoryBuffer Functions;
         totemMemoryBuffer Instructions;
         totemMemoryBuffer NativeFunctionNames;
         totemMemoryBuffer FunctionArguments;
         totemMemoryBuffer RecycledRegisters;
         totemMemoryBuffer AnonFunctions;
+        totemMemoryBuffer Templates;
+        totemMemoryBuffer TemplateValues;
         size_t CurrentAnonFunc;
         totemBufferPositionInfo *ErrorAt;
         totemFunctionDeclarationPrototype *AnonymousFunctionHead;
@@ -195,6 +217,7 @@ extern "C" {
     totemEvalStatus totemWhileLoopPrototype_EvalValues(totemWhileLoopPrototype *loop, totemBuildPrototype *build);
     totemEvalStatus totemIfBlockPrototype_EvalValues(totemIfBlockPrototype *loop, totemBuildPrototype *build);
     totemEvalStatus totemForLoopPrototype_EvalValues(totemForLoopPrototype *loop, totemBuildPrototype *build);
+    totemEvalStatus totemForEachLoopPrototype_EvalValues(totemForEachLoopPrototype *loop, totemBuildPrototype *build);
     totemEvalStatus totemDoWhileLoopPrototype_EvalValues(totemDoWhileLoopPrototype *loop, totemBuildPrototype *build);
     totemEvalStatus totemExpressionPrototype_EvalValues(totemExpressionPrototype *expression, totemBuildPrototype *build);
     totemEvalStatus totemArgumentPrototype_EvalValues(totemArgumentPrototype *arg, totemBuildPrototype *build);
@@ -222,11 +245,17 @@ extern "C" {
     totemEvalStatus totemWhileLoopPrototype_Eval(totemWhileLoopPrototype *whileLoop, totemBuildPrototype *build);
     totemEvalStatus totemDoWhileLoopPrototype_Eval(totemDoWhileLoopPrototype *doWhileLoop, totemBuildPrototype *build);
     totemEvalStatus totemForLoopPrototype_Eval(totemForLoopPrototype *forLoop, totemBuildPrototype *build);
+    totemEvalStatus totemForEachLoopPrototype_Eval(totemForEachLoopPrototype *forEachLoop, totemBuildPrototype *build);
     totemEvalStatus totemIfBlockPrototype_Eval(totemIfBlockPrototype *ifBlock, totemBuildPrototype *build);
     totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expression, totemBuildPrototype *build, totemOperandRegisterPrototype *lValueHint, totemOperandRegisterPrototype *value);
     totemEvalStatus totemArgumentPrototype_Eval(totemArgumentPrototype *argument, totemBuildPrototype *build, totemOperandRegisterPrototype *hint, totemOperandRegisterPrototype *value);
     totemEvalStatus totemNewArrayPrototype_Eval(totemNewArrayPrototype *newArray, totemBuildPrototype *build, totemOperandRegisterPrototype *hint, totemOperandRegisterPrototype *value);
+    totemEvalStatus totemNewObjectPrototype_Eval(totemNewObjectPrototype *obj, totemBuildPrototype *build, totemOperandRegisterPrototype *hint, totemOperandRegisterPrototype *value);
     totemEvalStatus totemVariablePrototype_Eval(totemVariablePrototype *variable, totemBuildPrototype *build, totemOperandRegisterPrototype *index);
+    totemEvalStatus totemStructDeclarationPrototype_Eval(totemStructDeclarationPrototype *dec, totemBuildPrototype *build);
+    totemEvalStatus totemStructDeclarationPrototype_EvalNew(totemStructDeclarationPrototype *dec, totemBuildPrototype *build, totemExpressionPrototype *parametersStart, totemOperandRegisterPrototype *value);
+    totemEvalStatus totemStructDeclarationPrototype_EvalCheck(totemStructDeclarationPrototype *dec, totemBuildPrototype *build, totemOperandRegisterPrototype *value, totemExpressionPrototype *source);
+    totemStructDeclarationPrototype *totemBuildPrototype_FindStruct(totemBuildPrototype *build, totemString *name);
     
     totemEvalStatus totemBuildPrototype_EvalAbcInstruction(totemBuildPrototype *build, totemOperandRegisterPrototype *a, totemOperandRegisterPrototype *b, totemOperandRegisterPrototype *c, totemOperationType operationType);
     totemEvalStatus totemBuildPrototype_EvalAbxInstructionSigned(totemBuildPrototype *build, totemOperandRegisterPrototype *a, totemOperandXSigned bx, totemOperationType operationType);
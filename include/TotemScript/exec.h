@@ -36,7 +36,9 @@ extern "C" {
         totemExecStatus_IndexOutOfBounds,
         totemExecStatus_RefCountOverflow,
         totemExecStatus_DivideByZero,
-        totemExecStatus_InternalBufferOverrun
+        totemExecStatus_InternalBufferOverrun,
+        totemExecStatus_FrozenValueModified,
+        totemExecStatus_ExternalValueResized
     }
     totemExecStatus;
     
@@ -68,6 +70,15 @@ extern "C" {
     
     const char *totemLinkStatus_Describe(totemLinkStatus status);
     
+    typedef struct
+    {
+        size_t ValuesStart;
+        size_t NumValues;
+        totemOperandXUnsigned Register;
+        totemPublicDataType Type;
+    }
+    totemScriptTemplate;
+    
     typedef struct
     {
         totemHashMap FunctionNameLookup;
@@ -75,6 +86,8 @@ extern "C" {
         totemMemoryBuffer Functions;
         totemMemoryBuffer FunctionNames;
         totemMemoryBuffer Instructions;
+        totemMemoryBuffer Templates;
+        totemMemoryBuffer TemplateValues;
     }
     totemScript;
     
@@ -123,15 +136,20 @@ extern "C" {
     {
         totemHash Hash;
         totemStringLength Length;
+        size_t Epoch;
         char Data[1];
     }
     totemInternedStringHeader;
     
+    // strings interned by the host or while linking are never reclaimed
+#define TOTEM_INTERNEDSTRING_PINNED (~((size_t)0))
+    
     typedef enum
     {
         totemFunctionCallFlag_None = 0,
         totemFunctionCallFlag_FreeStack = 1,
-        totemFunctionCallFlag_IsCoroutine = 2
+        totemFunctionCallFlag_IsCoroutine = 2,
+        totemFunctionCallFlag_ReturnToNative = 4
     }
     totemFunctionCallFlag;
     
@@ -195,8 +213,8 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
 #define totemPrivateDataType_Coroutine TOTEM_DATATYPE(10)
 #define totemPrivateDataType_Object TOTEM_DATATYPE(11)
 #define totemPrivateDataType_Userdata TOTEM_DATATYPE(12)
-#define totemPrivateDataType_Unused1 TOTEM_DATATYPE(13)
-#define totemPrivateDataType_Unused2 TOTEM_DATATYPE(14)
+#define totemPrivateDataType_Rope TOTEM_DATATYPE(13)
+#define totemPrivateDataType_TypedArray TOTEM_DATATYPE(14)
 #define totemPrivateDataType_Unused3 TOTEM_DATATYPE(15)
     
 #define TOTEM_TYPEPAIR(a, b) ((((uint32_t)(a)) << 16) | ((uint32_t)(b)))
@@ -253,8 +271,8 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
         totemPrivateDataType_Object = 10,
         totemPrivateDataType_Userdata = 11,
         totemPrivateDataType_Boolean = 12,
-        totemPrivateDataType_Unused1 = 13,
-        totemPrivateDataType_Unused2 = 14,
+        totemPrivateDataType_Rope = 13,
+        totemPrivateDataType_TypedArray = 14,
         totemPrivateDataType_Unused3 = 15
     };
     typedef uint8_t totemPrivateDataType;
@@ -314,9 +332,11 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     totemBool totemRegister_IsString(totemRegister *reg);
     totemBool totemRegister_IsInternedString(totemRegister *reg);
     totemBool totemRegister_IsMiniString(totemRegister *reg);
+    totemBool totemRegister_IsRope(totemRegister *reg);
     totemBool totemRegister_IsInt(totemRegister *reg);
     totemBool totemRegister_IsFloat(totemRegister *reg);
     totemBool totemRegister_IsArray(totemRegister *reg);
+    totemBool totemRegister_IsTypedArray(totemRegister *reg);
     totemBool totemRegister_IsObject(totemRegister *reg);
     totemBool totemRegister_IsNativeFunction(totemRegister *reg);
     totemBool totemRegister_IsInstanceFunction(totemRegister *reg);
@@ -366,13 +386,34 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     }
     totemFunctionCall;
     
+    // interned strings are split across several independently-locked tables by hash
+#define TOTEM_RUNTIME_NUMSTRINGSHARDS (16)
+#define TOTEM_RUNTIME_STRINGSHARD(hash) (((hash) >> 24) % TOTEM_RUNTIME_NUMSTRINGSHARDS)
+    
+    typedef struct
+    {
+        totemHashMap Strings;
+        totemLock Lock;
+        totemAllocator Allocator;
+    }
+    totemInternedStringShard;
+    
     typedef struct
     {
         totemMemoryBuffer NativeFunctions;
         totemMemoryBuffer NativeFunctionNames;
         totemHashMap NativeFunctionsLookup;
-        totemHashMap InternedStrings;
-        totemLock InternedStringsLock;
+        totemInternedStringShard InternedStrings[TOTEM_RUNTIME_NUMSTRINGSHARDS];
+        totemLock ExecStatesLock;
+        totemMemoryBuffer ExecStates;
+        size_t StringEpoch;
+        size_t StringSweepEpoch;
+        totemAllocator Allocator;
+        
+        // frozen values are allocated & linked under this lock, and freed along with the runtime
+        totemLock FrozenLock;
+        totemMemoryBuffer FrozenObjects;
+        totemAllocator FrozenAllocator;
     }
     totemRuntime;
     
@@ -399,7 +440,9 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
         totemGCObjectType_Coroutine,
         totemGCObjectType_Object,
         totemGCObjectType_Userdata,
-        totemGCObjectType_Instance
+        totemGCObjectType_Instance,
+        totemGCObjectType_Rope,
+        totemGCObjectType_TypedArray
     };
     typedef uint8_t totemGCObjectType;
     const char *totemGCObjectType_Describe(totemGCObjectType);
@@ -407,6 +450,86 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     struct totemExecState;
     typedef void(*totemUserdataDestructor)(struct totemExecState*, void*);
     
+    /**
+     * Concatenations above TOTEM_EXEC_ROPETHRESHOLD bytes produce ropes rather than interned strings
+     * A rope views the front of an append buffer shared with the ropes it was built from - appending to the rope at the tip of a buffer extends it in place,
+     * so building a string piece by piece is amortised linear
+     * Ropes are interned once, on demand, when they are hashed, used as object keys, cast or passed to native functions
+     * Substrings are ropes too - they view a range of their parent's buffer, or of an interned string when there is no buffer, without copying it
+     */
+    typedef struct totemRopeBuffer
+    {
+        char *Data;
+        size_t Length;
+        size_t Capacity;
+        size_t NumRopes;
+    }
+    totemRopeBuffer;
+    
+    typedef struct totemRope
+    {
+        totemRopeBuffer *Buffer;
+        totemInternedStringHeader *Source;
+        size_t Offset;
+        totemStringLength Length;
+        totemInternedStringHeader *Flattened;
+    }
+    totemRope;
+    
+    const char *totemRope_GetData(totemRope *rope);
+    
+    /**
+     * Objects
+     * - registers are laid out as key/value pairs, so keys are traversed (and their strings kept alive) along with values
+     * - objects with up to TOTEM_EXEC_SMALLOBJECTKEYS keys have no lookup, and find keys by scanning the pairs
+     * - past that, Lookup is built to map each key to its pair index
+     * - pairs left empty by removed keys have a null key, and are reused by the next new key
+     * - integer keys, and strings that spell one out exactly (e.g. "12" but not "012"), are stored as ints, everything else as a string
+     */
+    typedef struct
+    {
+        totemHashMap *Lookup;
+        size_t NumKeys;
+        size_t NumPairs;
+    }
+    totemObject;
+    
+#define TOTEM_OBJECT_KEY(gc, pair) ((gc)->Registers + ((pair) * 2))
+#define TOTEM_OBJECT_VALUE(gc, pair) ((gc)->Registers + ((pair) * 2) + 1)
+    
+    typedef enum
+    {
+        totemTypedArrayType_Float64,
+        totemTypedArrayType_Int32,
+        totemTypedArrayType_Int64,
+        totemTypedArrayType_Uint8,
+        totemTypedArrayType_Max
+    }
+    totemTypedArrayType;
+    
+    size_t totemTypedArrayType_GetElementSize(totemTypedArrayType type);
+    const char *totemTypedArrayType_Describe(totemTypedArrayType type);
+    
+    /**
+     * Typed arrays
+     * - elements are stored unboxed & contiguously in Data, so typed arrays hold no registers and are never traversed
+     * - to scripts they are arrays - reads give ints (floats for Float64), writes take ints or floats and convert them as C would
+     * - with NaN-boxing ints are 32 bits, so Int64 elements outside that range are truncated when read
+     * - Capacity elements follow the header in the same allocation, so growing past it moves the whole array
+     * - external typed arrays read & write host memory in place instead, and can't grow past the length they were created with - Release is called with Data once they're collected
+     */
+    typedef struct
+    {
+        void *Data;
+        size_t Length;
+        size_t Capacity;
+        totemTypedArrayType Type;
+        totemUserdataDestructor Release;
+    }
+    totemTypedArray;
+    
+#define TOTEM_TYPEDARRAY_ISEXTERNAL(arr) ((arr)->Data != (void*)((arr) + 1))
+    
     /*
      assuming that ref counts will never overflow
      - it is effectively impossible for every addressable memory location to hold a gc object
@@ -421,7 +544,8 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
         totemGCObjectMarkSweepFlag_None = 0,
         totemGCObjectMarkSweepFlag_Mark = 1,
         totemGCObjectMarkSweepFlag_IsGrey = 1 << 1,
-        totemGCObjectMarkSweepFlag_IsUsed = 1 << 2
+        totemGCObjectMarkSweepFlag_IsUsed = 1 << 2,
+        totemGCObjectMarkSweepFlag_IsFrozen = 1 << 3
     }
     totemGCObjectMarkSweepFlag;
     
@@ -432,9 +556,17 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
         union
         {
             totemFunctionCall *Coroutine;
-            totemHashMap *Object;
+            totemObject *Object;
             totemUserdataDestructor UserdataDestructor;
             totemInstance *Instance;
+            totemRope *Rope;
+            totemTypedArray *TypedArray;
+            
+            struct
+            {
+                size_t ArrayCapacity; // registers allocated, arrays may use fewer than this
+                struct totemGCObject *ArrayStore; // when set, Registers are borrowed from this array & must be copied before writing
+            };
         };
         
         union
@@ -456,6 +588,14 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     }
     totemGCObject;
     
+    /**
+     * Frozen objects
+     * - deep copies of arrays, typed arrays & objects, allocated from & owned by the runtime rather than an exec state
+     * - never written to, collected or traversed, so any exec state linked to the runtime may read them from any thread
+     * - strings they hold are pinned, and anything they hold that isn't a string or scalar is frozen too
+     */
+#define TOTEM_GCOBJECT_ISFROZEN(gc) (TOTEM_HASBITS((gc)->MarkFlags, totemGCObjectMarkSweepFlag_IsFrozen))
+    
 #ifdef __cplusplus
 #define TOTEM_JMP_TYPE char
 #define TOTEM_JMP_TRY(jmp) try
@@ -484,6 +624,11 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     }
     totemMarkSweepState;
     
+    // recently interned strings, checked before going to the runtime's shared tables
+#define TOTEM_EXEC_STRINGCACHESIZE (64)
+#define TOTEM_EXEC_ROPETHRESHOLD (32)
+#define TOTEM_EXEC_SMALLOBJECTKEYS (8)
+    
     typedef struct totemExecState
     {
 #if TOTEM_GCTYPE_ISREFCOUNTING
@@ -497,6 +642,8 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
         totemGCHeader GCSweep;
         totemMarkSweepState GCState;
         totemBool GCCurrentBit;
+        size_t StringMarkEpoch;
+        size_t StringSafeEpoch;
 #endif
         size_t GCNum;
         size_t GCNumBytes;
@@ -514,6 +661,8 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
         size_t UsedLocalRegisters;
         const char **ArgV;
         int ArgC;
+        totemAllocator Allocator;
+        totemInternedStringHeader *StringCache[TOTEM_EXEC_STRINGCACHESIZE];
     }
     totemExecState;
     
@@ -572,11 +721,36 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     totemBool totemRuntime_GetNativeFunctionAddress(totemRuntime *runtime, totemString *name, totemOperandXUnsigned *addressOut);
     totemBool totemRuntime_GetNativeFunctionName(totemRuntime *runtime, totemOperandXUnsigned addr, totemRuntimeStringValue *val);
     
+    
+    /**
+     * Strings interned by exec states are held weakly - once every exec state linked to the runtime has finished a mark cycle without reaching a string, it is freed
+     */
+    void totemInternedStringHeader_Mark(totemInternedStringHeader *str, size_t epoch);
+    
+    /**
+     * Interned strings are allocated from the runtime's allocator - must be set before any strings are interned
+     * Each string table shard allocates under its own lock, so the allocator must be safe to call from several threads at once
+     */
+    void totemRuntime_SetAllocator(totemRuntime *runtime, totemAllocator *allocator);
+    void totemRuntime_GetMemoryUsage(totemRuntime *runtime, size_t *numBytesOut, size_t *peakBytesOut);
+    
     void totemExecState_Init(totemExecState *state);
     void totemExecState_Cleanup(totemExecState *state);
     void totemExecState_SetArgV(totemExecState *state, const char **argv, int num);
+    
+    /**
+     * Objects, registers & call frames are allocated from the state's allocator - must be set before the state is linked
+     */
+    void totemExecState_SetAllocator(totemExecState *state, totemAllocator *allocator);
     void *totemExecState_Alloc(totemExecState *state, size_t size);
+    void totemExecState_Free(totemExecState *state, void *ptr, size_t size);
     totemExecStatus totemExecState_Exec(totemExecState *state, totemInstanceFunction *function);
+    
+    /**
+     * Calls function (a script or native function) with numArgs arguments from args, from within a native function
+     * Returns once the call has, with its return value in dst
+     */
+    totemExecStatus totemExecState_Call(totemExecState *state, totemRegister *function, totemRegister *args, uint8_t numArgs, totemRegister *dst);
     void totemExecState_ExecuteInstructions(totemExecState *state);
     
     void totemExecState_InitGC(totemExecState *state);
@@ -590,11 +764,45 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     totemExecStatus totemExecState_CreateObject(totemExecState *state, totemInt size, totemGCObject **objOut);
     totemExecStatus totemExecState_CreateArray(totemExecState *state, totemInt numRegisters, totemGCObject **objOut);
     totemExecStatus totemExecState_CreateUserdata(totemExecState *state, void *data, totemUserdataDestructor destructor, totemGCObject **gcOut);
+    totemExecStatus totemExecState_CreateRope(totemExecState *state, totemRopeBuffer *buffer, totemInternedStringHeader *source, size_t offset, totemStringLength length, totemGCObject **gcOut);
     totemExecStatus totemExecState_CreateArrayFromExisting(totemExecState *state, totemRegister *registers, size_t numRegisters, totemGCObject **objOut);
+    totemExecStatus totemExecState_CreateTypedArray(totemExecState *state, totemTypedArrayType type, totemInt length, totemGCObject **gcOut);
+    
+    /**
+     * Creates a typed array over length elements of host memory at data, without copying them
+     * The host must keep data alive until release is called with it (release may be NULL)
+     */
+    totemExecStatus totemExecState_CreateExternalTypedArray(totemExecState *state, totemTypedArrayType type, void *data, size_t length, totemUserdataDestructor release, totemGCObject **gcOut);
+    
+    /**
+     * Ensures the typed array can hold at least capacity elements without reallocating - gc->TypedArray may move
+     */
+    totemExecStatus totemExecState_ReserveTypedArray(totemExecState *state, totemGCObject *gc, size_t capacity);
+    
+    /**
+     * Ensures the array can hold at least capacity registers without reallocating
+     */
+    totemExecStatus totemExecState_ReserveArray(totemExecState *state, totemGCObject *gc, size_t capacity);
+    
+    /**
+     * Creates an array viewing length registers of src from offset onwards, without copying them
+     * Both arrays copy their registers the first time they're written to
+     */
+    totemExecStatus totemExecState_ShareArray(totemExecState *state, totemGCObject *src, size_t offset, size_t length, totemGCObject **gcOut);
+    totemExecStatus totemExecState_UnshareArray(totemExecState *state, totemGCObject *gc);
+    
+    /**
+     * Copies src into the runtime as a frozen value - values already frozen, and shared or cyclic values within src, are only copied once
+     * Functions, coroutines & userdata belong to their exec state, and can't be frozen
+     */
+    totemExecStatus totemExecState_Freeze(totemExecState *state, totemRegister *src, totemRegister *dst);
+    void totemRuntime_DestroyFrozenObject(totemRuntime *runtime, totemGCObject *gc);
     
     void totemExecState_DestroyCoroutine(totemExecState *state, totemFunctionCall *co);
-    void totemExecState_DestroyObject(totemExecState *state, totemHashMap *obj);
+    void totemExecState_DestroyObject(totemExecState *state, totemObject *obj);
     void totemExecState_DestroyInstance(totemExecState *state, totemInstance *obj);
+    void totemExecState_DestroyRope(totemExecState *state, totemRope *rope);
+    void totemExecState_DestroyTypedArray(totemExecState *state, totemTypedArray *arr);
     void totemExecState_CollectGarbage(totemExecState *state, totemBool full);
     
 #if TOTEM_GCTYPE_ISREFCOUNTING
@@ -605,6 +813,8 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
 #define totemExecState_IncRefCount(x, y)
 #define totemExecState_DecRefCount(x, y)
     void totemExecState_WriteBarrier(totemExecState *state, totemGCObject *gc);
+    void totemExecState_BeginStringMark(totemExecState *state);
+    void totemExecState_FinishStringMark(totemExecState *state);
 #endif
     
     totemExecStatus totemExecState_CreateSubroutine(totemExecState *state, uint8_t numRegisters, totemGCObject *instance, totemRegister *returnReg, totemFunctionType funcType, void *function, totemFunctionCall **callOut);
@@ -631,16 +841,57 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     totemExecStatus totemExecState_InternString(totemExecState *state, totemString *str, totemRegister *strOut);
     totemExecStatus totemExecState_InternStringChar(totemExecState *state, totemRegister *src, totemInt index, totemRegister *dst);
     totemExecStatus totemExecState_ConcatStrings(totemExecState *state, totemRegister *str1, totemRegister *str2, totemRegister *strOut);
+    totemExecStatus totemExecState_SliceString(totemExecState *state, totemRegister *src, totemInt start, totemInt length, totemRegister *strOut);
+    totemExecStatus totemExecState_StringByte(totemExecState *state, totemRegister *src, totemInt index, totemRegister *dst);
+    
+    /**
+     * Copies src to dst, interning it first if it is a rope - src & dst may be the same register
+     * Anything that needs a nul-terminated value or a stable hash should flatten first
+     */
+    totemExecStatus totemExecState_FlattenString(totemExecState *state, totemRegister *src, totemRegister *dst);
     
     totemExecStatus totemExecState_ArrayGet(totemExecState *state, totemRegister *arr, size_t len, totemInt index, totemRegister *dst);
     totemExecStatus totemExecState_ArraySet(totemExecState *state, totemRegister *arr, size_t len, totemInt index, totemRegister *src);
     totemExecStatus totemExecState_ArrayShift(totemExecState *state, totemRegister *arr, size_t len, totemInt index, totemRegister *dst);
     totemExecStatus totemExecState_ConcatArrays(totemExecState *state, totemRegister *src1, totemRegister *src2, totemRegister *dst);
+    totemExecStatus totemExecState_CloneObject(totemExecState *state, totemGCObject *src, totemGCObject **gcOut);
+    
+    /**
+     * Maps every pair of an object with no gaps to its index in lookup
+     */
+    totemBool totemObject_BuildLookup(totemGCObject *gc, totemHashMap *lookup);
+    
+    totemExecStatus totemExecState_ArrayPush(totemExecState *state, totemGCObject *gc, totemRegister *src);
+    totemExecStatus totemExecState_ArrayPop(totemExecState *state, totemGCObject *gc, totemRegister *dst);
+    
+    totemExecStatus totemExecState_TypedArrayGet(totemExecState *state, totemTypedArray *arr, totemInt index, totemRegister *dst);
+    totemExecStatus totemExecState_TypedArraySet(totemExecState *state, totemTypedArray *arr, totemInt index, totemRegister *src);
+    totemExecStatus totemExecState_TypedArrayShift(totemExecState *state, totemTypedArray *arr, totemInt index, totemRegister *dst);
+    totemExecStatus totemExecState_TypedArrayPush(totemExecState *state, totemGCObject *gc, totemRegister *src);
+    totemExecStatus totemExecState_TypedArrayPop(totemExecState *state, totemGCObject *gc, totemRegister *dst);
+    totemExecStatus totemExecState_TypedArrayToString(totemExecState *state, totemTypedArray *arr, totemRegister *strOut);
+    
+    /**
+     * Copies length elements of arr from offset onwards into a new typed array of the same type
+     */
+    totemExecStatus totemExecState_SliceTypedArray(totemExecState *state, totemTypedArray *arr, size_t offset, size_t length, totemGCObject **gcOut);
+    
+    /**
+     * Boxes each element into a new array
+     */
+    totemExecStatus totemExecState_TypedArrayToArray(totemExecState *state, totemTypedArray *arr, totemGCObject **gcOut);
     
     totemExecStatus totemExecState_ObjectGet(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *dst);
     totemExecStatus totemExecState_ObjectSet(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *src);
     totemExecStatus totemExecState_ObjectShift(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *dst);
     
+    /**
+     * Steps cursor (an int, starting at 0) on to the next element of an array, typed array or object, without allocating
+     * Sets key & value (which may be the same register) to its index or key & value, or sets *foundOut to false once there are none left
+     * Object pairs are visited in the order they're stored, so keys added or removed mid-loop may or may not be visited
+     */
+    totemExecStatus totemExecState_Next(totemExecState *state, totemRegister *src, totemRegister *cursor, totemRegister *key, totemRegister *value, totemBool *foundOut);
+    
     void totemExecState_Assign(totemExecState *state, totemRegister *dst, totemRegister *src);
     void totemExecState_AssignNewInt(totemExecState *state, totemRegister *dst, totemInt newVal);
     void totemExecState_AssignNewFloat(totemExecState *state, totemRegister *dst, totemFloat newVal);
@@ -653,6 +904,8 @@ TOTEM_BITMASK(uint16_t, 3, 12) |  /* all exponent bits + quiet NaN flag are set
     void totemExecState_AssignNewCoroutine(totemExecState *state, totemRegister *dst, totemGCObject *newVal);
     void totemExecState_AssignNewObject(totemExecState *state, totemRegister *dst, totemGCObject *newVal);
     void totemExecState_AssignNewUserdata(totemExecState *state, totemRegister *dst, totemGCObject *newVal);
+    void totemExecState_AssignNewRope(totemExecState *state, totemRegister *dst, totemGCObject *newVal);
+    void totemExecState_AssignNewTypedArray(totemExecState *state, totemRegister *dst, totemGCObject *newVal);
     void totemExecState_AssignNewBoolean(totemExecState *state, totemRegister *dst, totemBool newVal);
     void totemExecState_AssignNull(totemExecState *state, totemRegister *dst);
     
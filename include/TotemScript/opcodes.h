@@ -39,5 +39,7 @@ TOTEM_OPCODE_FORMAT(totemOperationType_NewObject)			\
 TOTEM_OPCODE_FORMAT(totemOperationType_ComplexShift)		\
 TOTEM_OPCODE_FORMAT(totemOperationType_PreInvoke)			\
 TOTEM_OPCODE_FORMAT(totemOperationType_LogicalNegate)	\
+TOTEM_OPCODE_FORMAT(totemOperationType_Next)	\
+TOTEM_OPCODE_FORMAT(totemOperationType_CheckStruct)	\
 
 #endif
\ No newline at end of file
@@ -34,15 +34,17 @@ extern "C" {
      
      while-loop = while-token expression lcbracket { statement } rcbracket-token
      for-loop = for-token lbracket statement statement statement rbracket rbracket lcbracket { statement } rcbracket-token
+     foreach-loop = foreach-token lbracket identifier-token [ comma-token identifier-token ] in-token expression rbracket lcbracket { statement } rcbracket-token
      do-while-loop = do-token lcbracket { statement } rcbracket while-token statement
      if-loop = if-token expression lcbracket { statement } rcbracket
      simple-statement = expression end-statement
      
-     statement = while-loop | for-loop | do-while-loop | if-loop | return | simple-statement
+     statement = while-loop | for-loop | foreach-loop | do-while-loop | if-loop | return | simple-statement
      function-declaration-body = function-token lbracket-token { variable } rbracket-token lcbracket-token { statement } rcbracket-token
      function-declaration = identifier-token function-declaration-body
+     struct-declaration = struct-token identifier-token lcbracket-token identifier-token { comma-token identifier-token } rcbracket-token
      
-     block = function-declaration | statement
+     block = function-declaration | struct-declaration | statement
      script = { block } end-script-token
      */
     
@@ -158,13 +160,15 @@ extern "C" {
         totemStatementType_IfBlock,
         totemStatementType_DoWhileLoop,
         totemStatementType_Return,
-        totemStatementType_Simple
+        totemStatementType_Simple,
+        totemStatementType_ForEachLoop
     }
     totemStatementType;
     
     typedef enum
     {
         totemBlockType_FunctionDeclaration = 1,
+        totemBlockType_StructDeclaration,
         totemBlockType_Statement
     }
     totemBlockType;
@@ -243,6 +247,9 @@ extern "C" {
         totemTokenType_At,
         totemTokenType_Coroutine,
         totemTokenType_Userdata,
+        totemTokenType_Struct,
+        totemTokenType_ForEach,
+        totemTokenType_In,
         totemTokenType_Max
     }
     totemTokenType;
@@ -286,6 +293,7 @@ extern "C" {
     typedef struct totemVariablePrototype
     {
         totemString Identifier;
+        totemString *Struct;
         totemBufferPositionInfo Position;
         struct totemVariablePrototype *Next;
         totemVariablePrototypeFlag Flags;
@@ -399,6 +407,20 @@ extern "C" {
     }
     totemForLoopPrototype;
     
+    /**
+     * Loops over the values of an array or object, and optionally their indices or keys too
+     * Key & Value are declared afresh in the loop's scope
+     */
+    typedef struct
+    {
+        struct totemStatementPrototype *StatementsStart;
+        totemVariablePrototype *Key;
+        totemVariablePrototype *Value;
+        totemExpressionPrototype *Collection;
+        totemBufferPositionInfo Position;
+    }
+    totemForEachLoopPrototype;
+    
     typedef struct
     {
         struct totemStatementPrototype *StatementsStart;
@@ -438,12 +460,25 @@ extern "C" {
     }
     totemFunctionDeclarationPrototype;
     
+    /**
+     * Records with a fixed set of fields, each given its own slot in order
+     */
+    typedef struct totemStructDeclarationPrototype
+    {
+        totemVariablePrototype *FieldsStart;
+        totemString *Identifier;
+        totemBufferPositionInfo Position;
+        totemInt NumFields;
+    }
+    totemStructDeclarationPrototype;
+    
     typedef struct totemStatementPrototype
     {
         union
         {
             totemWhileLoopPrototype *WhileLoop;
             totemForLoopPrototype *ForLoop;
+            totemForEachLoopPrototype *ForEachLoop;
             totemIfBlockPrototype *IfBlock;
             totemDoWhileLoopPrototype *DoWhileLoop;
             totemExpressionPrototype *Return;
@@ -460,6 +495,7 @@ extern "C" {
         union
         {
             totemFunctionDeclarationPrototype *FuncDec;
+            totemStructDeclarationPrototype *StructDec;
             totemStatementPrototype *Statement;
         };
         struct totemBlockPrototype *Next;
@@ -534,10 +570,12 @@ extern "C" {
     totemParseStatus totemStatementPrototype_Parse(totemStatementPrototype *statement, totemParseTree *tree);
     totemParseStatus totemStatementPrototype_ParseSet(totemStatementPrototype **firstStatement, totemStatementPrototype **lastStatement, totemParseTree *tree);
     totemParseStatus totemForLoopPrototype_Parse(totemForLoopPrototype *loop, totemParseTree *tree);
+    totemParseStatus totemForEachLoopPrototype_Parse(totemForEachLoopPrototype *loop, totemParseTree *tree);
     totemParseStatus totemWhileLoopPrototype_Parse(totemWhileLoopPrototype *loop, totemParseTree *tree);
     totemParseStatus totemDoWhileLoopPrototype_Parse(totemDoWhileLoopPrototype *loop, totemParseTree *tree);
     totemParseStatus totemIfBlockPrototype_Parse(totemIfBlockPrototype *block, totemParseTree *tree);
     totemParseStatus totemFunctionDeclarationPrototype_Parse(totemFunctionDeclarationPrototype *func, totemParseTree *tree, totemBool isAnonymous);
+    totemParseStatus totemStructDeclarationPrototype_Parse(totemStructDeclarationPrototype *dec, totemParseTree *tree);
     totemParseStatus totemExpressionPrototype_Parse(totemExpressionPrototype *expression, totemParseTree *tree);
     totemParseStatus totemExpressionPrototype_ParseParameterList(totemExpressionPrototype **first, totemExpressionPrototype **last, totemParseTree *tree, totemTokenType start, totemTokenType end, totemTokenType split);
     totemParseStatus totemExpressionPrototype_ParseParameterInList(totemExpressionPrototype **first, totemExpressionPrototype **last, totemParseTree *tree, totemTokenType end, totemTokenType split);
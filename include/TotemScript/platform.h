@@ -73,6 +73,9 @@
 #define TOTEM_INLINE __forceinline
 #define TOTEM_CDECL _cdecl
 #define TOTEM_UNREACHABLE() __assume(0)
+#define TOTEM_THREADLOCAL __declspec(thread)
+#define totem_AtomicCompareExchangeSize(ptr, oldVal, newVal) ((size_t)InterlockedCompareExchangePointer((PVOID volatile*)(ptr), (PVOID)(newVal), (PVOID)(oldVal)))
+#define totem_AtomicLoadSize(ptr) (*((volatile size_t*)(ptr)))
 #define totem_snprintf(dst, dstlen, format, ...) _snprintf_s(dst, dstlen, _TRUNCATE, format, __VA_ARGS__)
 
 #define PRISize "lu"
@@ -86,6 +89,9 @@
 #define TOTEM_CDECL __attribute__((cdecl))
 #define TOTEM_THREADED_DISPATCH
 #define TOTEM_UNREACHABLE() __builtin_unreachable()
+#define TOTEM_THREADLOCAL __thread
+#define totem_AtomicCompareExchangeSize(ptr, oldVal, newVal) __sync_val_compare_and_swap((ptr), (oldVal), (newVal))
+#define totem_AtomicLoadSize(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
 #define totem_snprintf snprintf
 
 #define PRISize "zu"
@@ -98,6 +104,9 @@
 #define TOTEM_CDECL __attribute__((cdecl))
 #define TOTEM_THREADED_DISPATCH
 #define TOTEM_UNREACHABLE() __builtin_unreachable()
+#define TOTEM_THREADLOCAL __thread
+#define totem_AtomicCompareExchangeSize(ptr, oldVal, newVal) __sync_val_compare_and_swap((ptr), (oldVal), (newVal))
+#define totem_AtomicLoadSize(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
 #define totem_snprintf snprintf
 
 #define PRISize "zu"
@@ -124,6 +133,7 @@ typedef int totemCwdSize_t;
 #define totemLock_Init InitializeCriticalSection
 #define totemLock_Cleanup DeleteCriticalSection
 #define totemLock_Acquire EnterCriticalSection
+#define totemLock_TryAcquire(x) (TryEnterCriticalSection(x) != 0)
 #define totemLock_Release LeaveCriticalSection
 
 #ifdef TOTEM_64
@@ -165,11 +175,13 @@ typedef size_t totemCwdSize_t;
 #ifdef TOTEM_POSIX
 #include <pthread.h>
 #include <unistd.h>
+#include <sys/mman.h>
 
 #define totemLock pthread_mutex_t
 #define totemLock_Init(x) pthread_mutex_init(x, NULL)
 #define totemLock_Cleanup pthread_mutex_destroy
 #define totemLock_Acquire pthread_mutex_lock
+#define totemLock_TryAcquire(x) (pthread_mutex_trylock(x) == 0)
 #define totemLock_Release pthread_mutex_unlock
 #endif
 
@@ -185,6 +197,22 @@ typedef size_t totemCwdSize_t;
 #define TOTEM_GCTYPE_ISREFCOUNTING (TOTEM_GCTYPE == TOTEM_GCTYPE_REFCOUNTING)
 #define TOTEM_GCTYPE_ISMARKANDSWEEP (TOTEM_GCTYPE == TOTEM_GCTYPE_MARKANDSWEEP)
 
+// memory options
+
+// each thread keeps a small magazine of free objects per size-class in front of the global free-lists
+// most cache allocations & frees become lock-free, the global lists are only touched to refill / spill a batch at a time
+// objects sitting in a thread's magazine can't be used by other threads until it is flushed with totem_FlushThreadCache() or the thread exits
+#define TOTEM_MEMOPT_THREAD_CACHE (1)
+
+// register stacks & large gc register blocks are carved from 2MB arenas backed by transparent huge pages
+// fewer TLB misses on register-heavy scripts, at the cost of reserving address space in 2MB chunks
+// falls back to the size-class cache when host memory callbacks are installed
+#if defined(TOTEM_LINUX) && defined(MADV_HUGEPAGE)
+#define TOTEM_MEMOPT_HUGEPAGES (1)
+#else
+#define TOTEM_MEMOPT_HUGEPAGES (0)
+#endif
+
 // compiliation options
 
 // global values are cached in local scope when not directly accessible
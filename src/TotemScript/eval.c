@@ -27,12 +27,15 @@ void totemBuildPrototype_Init(totemBuildPrototype *build)
 {
     totemRegisterListPrototype_Init(&build->GlobalRegisters, totemOperandType_GlobalRegister);
     totemHashMap_Init(&build->FunctionLookup);
+    totemHashMap_Init(&build->StructLookup);
     totemMemoryBuffer_Init(&build->Functions, sizeof(totemScriptFunctionPrototype));
     totemMemoryBuffer_Init(&build->Instructions, sizeof(totemInstruction));
     totemMemoryBuffer_Init(&build->NativeFunctionNames, sizeof(totemString));
     totemMemoryBuffer_Init(&build->FunctionArguments, sizeof(totemOperandRegisterPrototype));
     totemMemoryBuffer_Init(&build->RecycledRegisters, sizeof(totemOperandRegisterPrototype));
     totemMemoryBuffer_Init(&build->AnonFunctions, sizeof(totemOperandXUnsigned));
+    totemMemoryBuffer_Init(&build->Templates, sizeof(totemTemplatePrototype));
+    totemMemoryBuffer_Init(&build->TemplateValues, sizeof(totemOperandXUnsigned));
     build->AnonymousFunctionHead = NULL;
     build->AnonymousFunctionTail = NULL;
     build->LocalRegisters = NULL;
@@ -43,12 +46,15 @@ void totemBuildPrototype_Reset(totemBuildPrototype *build)
 {
     totemRegisterListPrototype_Reset(&build->GlobalRegisters);
     totemHashMap_Reset(&build->FunctionLookup);
+    totemHashMap_Reset(&build->StructLookup);
     totemMemoryBuffer_Reset(&build->Functions);
     totemMemoryBuffer_Reset(&build->Instructions);
     totemMemoryBuffer_Reset(&build->NativeFunctionNames);
     totemMemoryBuffer_Reset(&build->FunctionArguments);
     totemMemoryBuffer_Reset(&build->RecycledRegisters);
     totemMemoryBuffer_Reset(&build->AnonFunctions);
+    totemMemoryBuffer_Reset(&build->Templates);
+    totemMemoryBuffer_Reset(&build->TemplateValues);
     build->AnonymousFunctionHead = NULL;
     build->AnonymousFunctionTail = NULL;
     build->LocalRegisters = NULL;
@@ -59,12 +65,15 @@ void totemBuildPrototype_Cleanup(totemBuildPrototype *build)
 {
     totemRegisterListPrototype_Cleanup(&build->GlobalRegisters);
     totemHashMap_Cleanup(&build->FunctionLookup);
+    totemHashMap_Cleanup(&build->StructLookup);
     totemMemoryBuffer_Cleanup(&build->Functions);
     totemMemoryBuffer_Cleanup(&build->Instructions);
     totemMemoryBuffer_Cleanup(&build->NativeFunctionNames);
     totemMemoryBuffer_Cleanup(&build->FunctionArguments);
     totemMemoryBuffer_Cleanup(&build->RecycledRegisters);
     totemMemoryBuffer_Cleanup(&build->AnonFunctions);
+    totemMemoryBuffer_Cleanup(&build->Templates);
+    totemMemoryBuffer_Cleanup(&build->TemplateValues);
     build->AnonymousFunctionHead = NULL;
     build->AnonymousFunctionTail = NULL;
     build->LocalRegisters = NULL;
@@ -104,20 +113,20 @@ totemEvalStatus totemBuildPrototype_EvalFunctionCall(totemBuildPrototype *build,
         }
     }
     
-    // 2. alloc mem
-    totemMemoryBuffer_Reset(&build->FunctionArguments);
-    totemOperandRegisterPrototype *funcArgs = totemMemoryBuffer_Secure(&build->FunctionArguments, numArgs);
-    if (!funcArgs)
+    // 2. alloc mem - arguments may be function calls themselves, so each call takes its own slice of the buffer
+    size_t argsStart = totemMemoryBuffer_GetNumObjects(&build->FunctionArguments);
+    if (numArgs && !totemMemoryBuffer_Secure(&build->FunctionArguments, numArgs))
     {
         return totemEvalStatus_Break(totemEvalStatus_OutOfMemory);
     }
     
-    // 3. eval args
+    // 3. eval args - nested calls may move the buffer, so don't hold on to pointers into it while evaluating
     totemOperandXUnsigned currentArg = 0;
     for (totemExpressionPrototype *parameter = parametersStart; parameter != NULL; parameter = parameter->Next)
     {
-        totemOperandRegisterPrototype *operand = &funcArgs[currentArg];
-        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(parameter, build, NULL, operand));
+        totemOperandRegisterPrototype operand;
+        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(parameter, build, NULL, &operand));
+        memcpy(totemMemoryBuffer_Get(&build->FunctionArguments, argsStart + currentArg), &operand, sizeof(operand));
         currentArg++;
     }
     
@@ -129,11 +138,13 @@ totemEvalStatus totemBuildPrototype_EvalFunctionCall(totemBuildPrototype *build,
     // function arguments
     for (size_t i = 0; i < numArgs; i++)
     {
-        totemOperandRegisterPrototype *operand = totemMemoryBuffer_Get(&build->FunctionArguments, i);
+        totemOperandRegisterPrototype *operand = totemMemoryBuffer_Get(&build->FunctionArguments, argsStart + i);
         TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbxInstructionUnsigned(build, operand, numArgs, totemOperationType_FunctionArg));
         TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, operand));
     }
     
+    totemMemoryBuffer_Pop(&build->FunctionArguments, numArgs);
+    
     // finish function call
     TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RotateAllGlobalCaches(build, localScope, totemBool_False));
     TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbxInstructionUnsigned(build, dst, 0, totemOperationType_Invoke));
@@ -414,7 +425,8 @@ totemEvalStatus totemBuildPrototype_Eval(totemBuildPrototype *build, totemParseT
             case totemBlockType_FunctionDeclaration:
             {
                 // named function cannot already exist
-                if (totemHashMap_Find(&build->FunctionLookup, block->FuncDec->Identifier->Value, block->FuncDec->Identifier->Length) != NULL)
+                if (totemHashMap_Find(&build->FunctionLookup, block->FuncDec->Identifier->Value, block->FuncDec->Identifier->Length) != NULL
+                    || totemHashMap_Find(&build->StructLookup, block->FuncDec->Identifier->Value, block->FuncDec->Identifier->Length) != NULL)
                 {
                     return totemBuildPrototype_Break(build, totemEvalStatus_ScriptFunctionAlreadyDefined, &block->FuncDec->Position);
                 }
@@ -439,6 +451,10 @@ totemEvalStatus totemBuildPrototype_Eval(totemBuildPrototype *build, totemParseT
                 break;
             }
                 
+            case totemBlockType_StructDeclaration:
+                TOTEM_EVAL_CHECKRETURN(totemStructDeclarationPrototype_Eval(block->StructDec, build));
+                break;
+                
             default:
                 break;
         }
@@ -591,6 +607,11 @@ totemEvalStatus totemFunctionDeclarationPrototype_Eval(totemFunctionDeclarationP
     {
         totemOperandRegisterPrototype dummy;
         TOTEM_EVAL_CHECKRETURN(totemVariablePrototype_Eval(parameter, build, &dummy));
+        
+        if (parameter->Struct)
+        {
+            TOTEM_EVAL_CHECKRETURN(totemStructDeclarationPrototype_EvalCheck(totemBuildPrototype_FindStruct(build, parameter->Struct), build, &dummy, NULL));
+        }
     }
     
     // loop through statements & create instructions
@@ -621,6 +642,10 @@ totemEvalStatus totemStatementPrototype_Eval(totemStatementPrototype *statement,
             TOTEM_EVAL_CHECKRETURN(totemForLoopPrototype_Eval(statement->ForLoop, build));
             break;
             
+        case totemStatementType_ForEachLoop:
+            TOTEM_EVAL_CHECKRETURN(totemForEachLoopPrototype_Eval(statement->ForEachLoop, build));
+            break;
+            
         case totemStatementType_IfBlock:
             TOTEM_EVAL_CHECKRETURN(totemIfBlockPrototype_Eval(statement->IfBlock, build));
             break;
@@ -656,15 +681,165 @@ totemEvalStatus totemBuildPrototype_EvalArrayAccessEnd(totemBuildPrototype *buil
     return totemEvalStatus_Success;
 }
 
+totemStructDeclarationPrototype *totemBuildPrototype_FindStruct(totemBuildPrototype *build, totemString *name)
+{
+    totemHashMapEntry *entry = totemHashMap_Find(&build->StructLookup, name->Value, name->Length);
+    if (!entry)
+    {
+        return NULL;
+    }
+    
+    return (totemStructDeclarationPrototype*)entry->Value;
+}
+
+static totemBool totemStructDeclarationPrototype_FindField(totemStructDeclarationPrototype *dec, totemString *name, totemInt *fieldOut)
+{
+    totemInt field = 0;
+    for (totemVariablePrototype *var = dec->FieldsStart; var; var = var->Next)
+    {
+        if (var->Identifier.Length == name->Length && memcmp(var->Identifier.Value, name->Value, name->Length) == 0)
+        {
+            *fieldOut = field;
+            return totemBool_True;
+        }
+        
+        field++;
+    }
+    
+    return totemBool_False;
+}
+
+totemEvalStatus totemStructDeclarationPrototype_Eval(totemStructDeclarationPrototype *dec, totemBuildPrototype *build)
+{
+    // structs share a namespace with script functions, as both are invoked by name
+    if (totemHashMap_Find(&build->StructLookup, dec->Identifier->Value, dec->Identifier->Length) != NULL
+        || totemHashMap_Find(&build->FunctionLookup, dec->Identifier->Value, dec->Identifier->Length) != NULL)
+    {
+        return totemBuildPrototype_Break(build, totemEvalStatus_IdentifierAlreadyDefined, &dec->Position);
+    }
+    
+    for (totemVariablePrototype *field = dec->FieldsStart; field; field = field->Next)
+    {
+        for (totemVariablePrototype *other = field->Next; other; other = other->Next)
+        {
+            if (other->Identifier.Length == field->Identifier.Length && memcmp(other->Identifier.Value, field->Identifier.Value, field->Identifier.Length) == 0)
+            {
+                return totemBuildPrototype_Break(build, totemEvalStatus_IdentifierAlreadyDefined, &other->Position);
+            }
+        }
+    }
+    
+    if (!totemHashMap_Insert(&build->StructLookup, dec->Identifier->Value, dec->Identifier->Length, (totemHashValue)dec))
+    {
+        return totemBuildPrototype_Break(build, totemEvalStatus_OutOfMemory, &dec->Position);
+    }
+    
+    return totemEvalStatus_Success;
+}
+
+// records are plain arrays with a slot per field, filled in order by the arguments given
+// never built in-place, as the arguments may well read from whatever it's being assigned to
+totemEvalStatus totemStructDeclarationPrototype_EvalNew(totemStructDeclarationPrototype *dec, totemBuildPrototype *build, totemExpressionPrototype *parametersStart, totemOperandRegisterPrototype *value)
+{
+    totemOperandRegisterPrototype size;
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalInt(build, dec->NumFields, &size, NULL));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_AddRegister(build, totemOperandType_LocalRegister, value));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &size, &size, totemOperationType_NewArray));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &size));
+    
+    totemInt field = 0;
+    for (totemExpressionPrototype *parameter = parametersStart; parameter; parameter = parameter->Next)
+    {
+        if (field >= dec->NumFields)
+        {
+            return totemBuildPrototype_Break(build, totemEvalStatus_TooManyFunctionArguments, &parameter->Position);
+        }
+        
+        totemOperandRegisterPrototype index, member;
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalInt(build, field, &index, NULL));
+        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(parameter, build, NULL, &member));
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &index, &member, totemOperationType_ComplexSet));
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &index));
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &member));
+        field++;
+    }
+    
+    return totemEvalStatus_Success;
+}
+
+static totemBool totemBuildPrototype_IsVariable(totemBuildPrototype *build, totemString *name)
+{
+    totemOperandRegisterPrototype dummy;
+    return totemRegisterListPrototype_GetVariable(totemBuildPrototype_GetLocalScope(build), name, &dummy, totemBool_False)
+        || totemRegisterListPrototype_GetVariable(&build->GlobalRegisters, name, &dummy, totemBool_False);
+}
+
+// .field & ["field"] on a value whose struct is known at compile-time become a fixed index instead
+static totemBool totemExpressionPrototype_IsFieldName(totemExpressionPrototype *exp)
+{
+    return exp->LValueType == totemLValueType_Argument
+        && exp->LValueArgument->Type == totemArgumentType_String
+        && !exp->PreUnaryOperators
+        && !exp->PostUnaryOperators
+        && exp->BinaryOperator == totemBinaryOperatorType_None;
+}
+
+// field access is resolved at compile-time, so whatever is stored under a struct annotation has to be checked at run-time
+// constructing the same struct directly needs no check, as the record it builds is already the right shape
+totemEvalStatus totemStructDeclarationPrototype_EvalCheck(totemStructDeclarationPrototype *dec, totemBuildPrototype *build, totemOperandRegisterPrototype *value, totemExpressionPrototype *source)
+{
+    // rvalues come wrapped in an expression of their own
+    while (source
+        && source->LValueType == totemLValueType_Expression
+        && !source->PreUnaryOperators
+        && !source->PostUnaryOperators
+        && source->BinaryOperator == totemBinaryOperatorType_None)
+    {
+        source = source->LValueExpression;
+    }
+    
+    if (source
+        && source->LValueType == totemLValueType_Argument
+        && source->LValueArgument->Type == totemArgumentType_Identifier
+        && !source->PreUnaryOperators
+        && source->PostUnaryOperators
+        && source->PostUnaryOperators->Type == totemPostUnaryOperatorType_Invocation
+        && !source->PostUnaryOperators->Next
+        && source->BinaryOperator == totemBinaryOperatorType_None
+        && totemBuildPrototype_FindStruct(build, source->LValueArgument->Identifier) == dec)
+    {
+        return totemEvalStatus_Success;
+    }
+    
+    return totemBuildPrototype_EvalAbxInstructionUnsigned(build, value, (totemOperandXUnsigned)dec->NumFields, totemOperationType_CheckStruct);
+}
+
 totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expression, totemBuildPrototype *build, totemOperandRegisterPrototype *lValueHint, totemOperandRegisterPrototype *result)
 {
     totemOperandRegisterPrototype lValueSrc;
+    totemPostUnaryOperatorPrototype *postUnaryOperators = expression->PostUnaryOperators;
+    totemStructDeclarationPrototype *lValueStruct = NULL;
     
     // evaluate lvalue result to register
     switch(expression->LValueType)
     {
         case totemLValueType_Argument:
-            TOTEM_EVAL_CHECKRETURN(totemArgumentPrototype_Eval(expression->LValueArgument, build, lValueHint, &lValueSrc));
+            // invoking a struct by name creates a new record of it, unless a variable of that name is in scope
+            if (expression->LValueArgument->Type == totemArgumentType_Identifier && postUnaryOperators && postUnaryOperators->Type == totemPostUnaryOperatorType_Invocation
+                && !totemBuildPrototype_IsVariable(build, expression->LValueArgument->Identifier))
+            {
+                lValueStruct = totemBuildPrototype_FindStruct(build, expression->LValueArgument->Identifier);
+            }
+            
+            if (lValueStruct)
+            {
+                TOTEM_EVAL_CHECKRETURN(totemStructDeclarationPrototype_EvalNew(lValueStruct, build, postUnaryOperators->InvocationParametersStart, &lValueSrc));
+                postUnaryOperators = postUnaryOperators->Next;
+            }
+            else
+            {
+                TOTEM_EVAL_CHECKRETURN(totemArgumentPrototype_Eval(expression->LValueArgument, build, lValueHint, &lValueSrc));
+            }
             break;
             
         case totemLValueType_Expression:
@@ -681,6 +856,11 @@ totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expressi
     totemRegisterListPrototype *lValueSrcScope = totemBuildPrototype_GetRegisterList(build, lValueSrc.RegisterScopeType);
     totemRegisterListPrototype_GetRegisterFlags(lValueSrcScope, lValueSrc.RegisterIndex, &lValueSrcFlags);
     
+    if (!lValueStruct)
+    {
+        totemRegisterListPrototype_GetRegisterStruct(lValueSrcScope, lValueSrc.RegisterIndex, &lValueStruct);
+    }
+    
     // check the operators used against this lvalue to see if it gets mutated
     for(totemPreUnaryOperatorPrototype *op = expression->PreUnaryOperators; op != NULL; op = op->Next)
     {
@@ -696,7 +876,7 @@ totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expressi
         }
     }
     
-    for(totemPostUnaryOperatorPrototype *op = expression->PostUnaryOperators; op != NULL; op = op->Next)
+    for(totemPostUnaryOperatorPrototype *op = postUnaryOperators; op != NULL; op = op->Next)
     {
         if(op->Type == totemPostUnaryOperatorType_Dec || op->Type == totemPostUnaryOperatorType_Inc)
         {
@@ -757,7 +937,7 @@ totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expressi
     {
         size_t accessesPerformed = 0;
         
-        for(totemPostUnaryOperatorPrototype *op = expression->PostUnaryOperators; op != NULL; op = op->Next)
+        for(totemPostUnaryOperatorPrototype *op = postUnaryOperators; op != NULL; op = op->Next)
         {
             switch (op->Type)
             {
@@ -772,7 +952,23 @@ totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expressi
                     lValueSrcFlags = lValueFlags;
                     lValueSrcScope = lValueScope;
                     
-                    TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(op->ArrayAccess, build, NULL, &arrIndex));
+                    if (lValueStruct && totemExpressionPrototype_IsFieldName(op->ArrayAccess))
+                    {
+                        totemInt field = 0;
+                        if (!totemStructDeclarationPrototype_FindField(lValueStruct, op->ArrayAccess->LValueArgument->String, &field))
+                        {
+                            return totemBuildPrototype_Break(build, totemEvalStatus_StructFieldNotDefined, &op->ArrayAccess->Position);
+                        }
+                        
+                        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalInt(build, field, &arrIndex, NULL));
+                    }
+                    else
+                    {
+                        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(op->ArrayAccess, build, NULL, &arrIndex));
+                    }
+                    
+                    // fields aren't typed, so only the first access knows its struct
+                    lValueStruct = NULL;
                     
                     totemBool performAccess = totemBool_True;
                     totemBool shouldShift = totemBool_False;
@@ -830,6 +1026,7 @@ totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expressi
                     
                 case totemPostUnaryOperatorType_Invocation:
                     accessesPerformed++;
+                    lValueStruct = NULL;
                     
                     if (TOTEM_HASBITS(lValueFlags, totemRegisterPrototypeFlag_IsValue))
                     {
@@ -920,7 +1117,7 @@ totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expressi
     totemString postUnaryNumber;
     totemString_FromLiteral(&postUnaryNumber, "0");
     
-    for(totemPostUnaryOperatorPrototype *op = expression->PostUnaryOperators; op != NULL; op = op->Next)
+    for(totemPostUnaryOperatorPrototype *op = postUnaryOperators; op != NULL; op = op->Next)
     {
         switch(op->Type)
         {
@@ -1154,6 +1351,12 @@ totemEvalStatus totemExpressionPrototype_Eval(totemExpressionPrototype *expressi
         totemRegisterListPrototype_SetRegisterFlags(lValueSrcScope, lValueSrc.RegisterIndex, totemRegisterPrototypeFlag_IsAssigned);
     }
     
+    // storing straight into a struct-annotated variable
+    if (mutatedLValueRegisterBinary && lValueStruct && !lValueRegisterIsArrayMember && !lValueRegisterIsInvocation)
+    {
+        TOTEM_EVAL_CHECKRETURN(totemStructDeclarationPrototype_EvalCheck(lValueStruct, build, &lValue, expression->BinaryOperator == totemBinaryOperatorType_Assign ? expression->RValue : NULL));
+    }
+    
     // finish the array-access if the value was mutated
     if (lValueRegisterIsArrayMember && (mutatedLValueRegisterUnary || mutatedLValueRegisterBinary) && !TOTEM_HASBITS(expression->Flags, totemExpressionPrototypeFlag_ShiftSource))
     {
@@ -1177,6 +1380,92 @@ totemEvalStatus totemArgumentPrototype_EvalHint(totemBuildPrototype *build, tote
     return totemEvalStatus_Success;
 }
 
+// literal values that need no instructions to produce can be baked into a template
+static totemBool totemExpressionPrototype_IsConstant(totemExpressionPrototype *exp)
+{
+    if (exp->LValueType != totemLValueType_Argument || exp->PreUnaryOperators || exp->PostUnaryOperators || exp->BinaryOperator != totemBinaryOperatorType_None)
+    {
+        return totemBool_False;
+    }
+    
+    switch (exp->LValueArgument->Type)
+    {
+        case totemArgumentType_Null:
+        case totemArgumentType_Boolean:
+        case totemArgumentType_Number:
+        case totemArgumentType_String:
+        case totemArgumentType_Type:
+            return totemBool_True;
+            
+        default:
+            return totemBool_False;
+    }
+}
+
+// global register of a constant expression, or of null for anything else
+static totemEvalStatus totemBuildPrototype_EvalTemplateValue(totemBuildPrototype *build, totemExpressionPrototype *exp)
+{
+    totemOperandRegisterPrototype op;
+    totemRegisterListPrototype *globals = &build->GlobalRegisters;
+    
+    if (!totemExpressionPrototype_IsConstant(exp))
+    {
+        TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddNull(globals, &op));
+    }
+    else
+    {
+        totemArgumentPrototype *arg = exp->LValueArgument;
+        
+        switch (arg->Type)
+        {
+            case totemArgumentType_Boolean:
+                TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddBoolean(globals, arg->Boolean, &op));
+                break;
+                
+            case totemArgumentType_Number:
+                TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddNumberConstant(globals, arg->Number, &op));
+                break;
+                
+            case totemArgumentType_String:
+                TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddStringConstant(globals, arg->String, &op));
+                break;
+                
+            case totemArgumentType_Type:
+                TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddType(globals, arg->DataType, &op));
+                break;
+                
+            default:
+                TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddNull(globals, &op));
+                break;
+        }
+    }
+    
+    if (!totemMemoryBuffer_Insert(&build->TemplateValues, &op.RegisterIndex, 1))
+    {
+        return totemEvalStatus_Break(totemEvalStatus_OutOfMemory);
+    }
+    
+    return totemEvalStatus_Success;
+}
+
+static totemEvalStatus totemBuildPrototype_EvalTemplate(totemBuildPrototype *build, totemPublicDataType type, size_t valuesStart, totemOperandRegisterPrototype *op)
+{
+    TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddTemplate(&build->GlobalRegisters, type, op));
+    
+    totemTemplatePrototype *prototype = totemMemoryBuffer_Secure(&build->Templates, 1);
+    if (!prototype)
+    {
+        return totemEvalStatus_Break(totemEvalStatus_OutOfMemory);
+    }
+    
+    prototype->Register = op->RegisterIndex;
+    prototype->Type = type;
+    prototype->ValuesStart = valuesStart;
+    prototype->NumValues = totemMemoryBuffer_GetNumObjects(&build->TemplateValues) - valuesStart;
+    
+    return totemBuildPrototype_GlobalCacheCheck(build, op, NULL);
+}
+
 totemEvalStatus totemNewObjectPrototype_Eval(totemNewObjectPrototype *obj, totemBuildPrototype *build, totemOperandRegisterPrototype *hint, totemOperandRegisterPrototype *value)
 {
     TOTEM_EVAL_CHECKRETURN(totemArgumentPrototype_EvalHint(build, value, hint));
@@ -1184,21 +1473,59 @@ totemEvalStatus totemNewObjectPrototype_Eval(totemNewObjectPrototype *obj, totem
     totemOperandRegisterPrototype size;
     TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalInt(build, obj->Num, &size, NULL));
     
-    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &size, &size, totemOperationType_NewObject));
+    // objects with constant keys are cloned from a template holding those keys & any constant values
+    totemBool useTemplate = obj->Keys != NULL;
+    totemExpressionPrototype *firstSet = obj->Keys;
+    totemExpressionPrototype *firstSetValue = obj->Values;
+    
+    for (totemExpressionPrototype *key = obj->Keys; key; key = key->Next)
+    {
+        if (!totemExpressionPrototype_IsConstant(key))
+        {
+            useTemplate = totemBool_False;
+            break;
+        }
+    }
+    
+    if (useTemplate)
+    {
+        size_t valuesStart = totemMemoryBuffer_GetNumObjects(&build->TemplateValues);
+        firstSet = NULL;
+        firstSetValue = NULL;
+        
+        for (totemExpressionPrototype *key = obj->Keys, *val = obj->Values; key; key = key->Next, val = val->Next)
+        {
+            TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalTemplateValue(build, key));
+            TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalTemplateValue(build, val));
+            
+            // set everything from the first non-constant value onwards, so repeated keys still end up with the last value given
+            if (!firstSet && !totemExpressionPrototype_IsConstant(val))
+            {
+                firstSet = key;
+                firstSetValue = val;
+            }
+        }
+        
+        totemOperandRegisterPrototype templateReg;
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalTemplate(build, totemPublicDataType_Object, valuesStart, &templateReg));
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &size, &templateReg, totemOperationType_NewObject));
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &templateReg));
+    }
+    else
+    {
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &size, &size, totemOperationType_NewObject));
+    }
     
-    while (obj->Keys)
+    for (totemExpressionPrototype *keyExp = firstSet, *valExp = firstSetValue; keyExp; keyExp = keyExp->Next, valExp = valExp->Next)
     {
         totemOperandRegisterPrototype key, val;
-        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(obj->Keys, build, NULL, &key));
-        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(obj->Values, build, NULL, &val));
+        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(keyExp, build, NULL, &key));
+        TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(valExp, build, NULL, &val));
         
         TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &key, &val, totemOperationType_ComplexSet));
         
         TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &key));
         TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &val));
-        
-        obj->Keys = obj->Keys->Next;
-        obj->Values = obj->Values->Next;
     }
     
     return totemEvalStatus_Success;
@@ -1245,14 +1572,19 @@ totemEvalStatus totemArgumentPrototype_Eval(totemArgumentPrototype *argument, to
 
 totemEvalStatus totemNewArrayPrototype_Eval(totemNewArrayPrototype *newArray, totemBuildPrototype *build, totemOperandRegisterPrototype *hint, totemOperandRegisterPrototype *value)
 {
-    totemOperandRegisterPrototype arraySize, c;
-    memset(&c, 0, sizeof(totemOperandRegisterPrototype));
+    totemOperandRegisterPrototype arraySize;
+    totemBool useTemplate = totemBool_False;
     
     if (newArray->isInitList)
     {
         totemInt num = 0;
         for (totemExpressionPrototype *exp = newArray->Accessor; exp; exp = exp->Next)
         {
+            if (totemExpressionPrototype_IsConstant(exp))
+            {
+                useTemplate = totemBool_True;
+            }
+            
             num++;
         }
         
@@ -1264,7 +1596,26 @@ totemEvalStatus totemNewArrayPrototype_Eval(totemNewArrayPrototype *newArray, to
     }
     
     TOTEM_EVAL_CHECKRETURN(totemArgumentPrototype_EvalHint(build, value, hint));
-    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &arraySize, &c, totemOperationType_NewArray));
+    
+    // literals with any constant values are cloned from a template holding them, leaving the rest to be set one by one
+    if (useTemplate)
+    {
+        size_t valuesStart = totemMemoryBuffer_GetNumObjects(&build->TemplateValues);
+        for (totemExpressionPrototype *exp = newArray->Accessor; exp; exp = exp->Next)
+        {
+            TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalTemplateValue(build, exp));
+        }
+        
+        totemOperandRegisterPrototype templateReg;
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalTemplate(build, totemPublicDataType_Array, valuesStart, &templateReg));
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &arraySize, &templateReg, totemOperationType_NewArray));
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &templateReg));
+    }
+    else
+    {
+        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &arraySize, &arraySize, totemOperationType_NewArray));
+    }
+    
     TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &arraySize));
     
     if (newArray->isInitList)
@@ -1273,6 +1624,12 @@ totemEvalStatus totemNewArrayPrototype_Eval(totemNewArrayPrototype *newArray, to
         totemOperandRegisterPrototype index, member;
         for (totemExpressionPrototype *exp = newArray->Accessor; exp; exp = exp->Next)
         {
+            if (useTemplate && totemExpressionPrototype_IsConstant(exp))
+            {
+                num++;
+                continue;
+            }
+            
             TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalInt(build, num, &index, NULL));
             TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(exp, build, NULL, &member));
             TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, value, &index, &member, totemOperationType_ComplexSet));
@@ -1297,6 +1654,18 @@ totemEvalStatus totemVariablePrototype_Eval(totemVariablePrototype *variable, to
     
     // create locally
     TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_AddVariable(localScope, &variable->Identifier, index));
+    
+    if (variable->Struct)
+    {
+        totemStructDeclarationPrototype *dec = totemBuildPrototype_FindStruct(build, variable->Struct);
+        if (!dec)
+        {
+            return totemBuildPrototype_Break(build, totemEvalStatus_IdentifierNotDefined, &variable->Position);
+        }
+        
+        totemRegisterListPrototype_SetRegisterStruct(localScope, index->RegisterIndex, dec);
+    }
+    
     TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_GlobalCacheCheck(build, index, NULL));
     
     totemRegisterListPrototype *scope = totemBuildPrototype_GetRegisterList(build, index->RegisterScopeType);
@@ -1352,6 +1721,7 @@ const char *totemEvalStatus_Describe(totemEvalStatus status)
     switch(status)
     {
             TOTEM_STRINGIFY_CASE(totemEvalStatus_InvalidShiftSource);
+            TOTEM_STRINGIFY_CASE(totemEvalStatus_StructFieldNotDefined);
             TOTEM_STRINGIFY_CASE(totemEvalStatus_InvalidDataType);
             TOTEM_STRINGIFY_CASE(totemEvalStatus_ScriptFunctionAlreadyDefined);
             TOTEM_STRINGIFY_CASE(totemEvalStatus_FunctionNotDefined);
@@ -12,40 +12,38 @@
 totemEvalStatus totemBuildPrototype_RotateGlobalCache(totemBuildPrototype *build, totemRegisterListPrototype *list, totemRegisterListPrototypeScope *scope, totemBool toLocal)
 {
 #if TOTEM_EVALOPT_GLOBAL_CACHE
-    for (size_t i = 0; i < scope->MoveToLocalVars.NumBuckets; i++)
+    size_t index = 0;
+    for (totemHashMapEntry *entry = totemHashMap_Iterate(&scope->MoveToLocalVars, &index); entry != NULL; entry = totemHashMap_Iterate(&scope->MoveToLocalVars, &index))
     {
-        for (totemHashMapEntry *entry = scope->MoveToLocalVars.Buckets[i]; entry != NULL; entry = entry->Next)
+        totemOperandXUnsigned globalCache = 0;
+        
+        if (totemRegisterListPrototype_GetRegisterGlobalCache(list, (totemOperandXUnsigned)entry->Value, &globalCache))
         {
-            totemOperandXUnsigned globalCache = 0;
-            
-            if (totemRegisterListPrototype_GetRegisterGlobalCache(list, (totemOperandXUnsigned)entry->Value, &globalCache))
+            totemRegisterPrototypeFlag globalFlags;
+            if (totemRegisterListPrototype_GetRegisterFlags(&build->GlobalRegisters, globalCache, &globalFlags)
+                && !TOTEM_HASANYBITS(globalFlags, totemRegisterPrototypeFlag_IsValue | totemRegisterPrototypeFlag_IsConst))
             {
-                totemRegisterPrototypeFlag globalFlags;
-                if (totemRegisterListPrototype_GetRegisterFlags(&build->GlobalRegisters, globalCache, &globalFlags)
-                    && !TOTEM_HASANYBITS(globalFlags, totemRegisterPrototypeFlag_IsValue | totemRegisterPrototypeFlag_IsConst))
+                totemRegisterPrototypeFlag localFlags;
+                if (totemRegisterListPrototype_GetRegisterFlags(list, (totemOperandXUnsigned)entry->Value, &localFlags))
                 {
-                    totemRegisterPrototypeFlag localFlags;
-                    if (totemRegisterListPrototype_GetRegisterFlags(list, (totemOperandXUnsigned)entry->Value, &localFlags))
-                    {
-                        if (!TOTEM_HASBITS(globalFlags, totemRegisterPrototypeFlag_IsAssigned) && !TOTEM_HASBITS(localFlags, totemRegisterPrototypeFlag_IsAssigned))
-                        {
-                            continue;
-                        }
-                    }
-                    
-                    totemOperandRegisterPrototype dummy;
-                    dummy.RegisterIndex = (totemOperandXUnsigned)entry->Value;
-                    dummy.RegisterScopeType = totemOperandType_LocalRegister;
-                    
-                    if (toLocal)
+                    if (!TOTEM_HASBITS(globalFlags, totemRegisterPrototypeFlag_IsAssigned) && !TOTEM_HASBITS(localFlags, totemRegisterPrototypeFlag_IsAssigned))
                     {
-                        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbxInstructionUnsigned(build, &dummy, globalCache, totemOperationType_MoveToLocal));
-                    }
-                    else
-                    {
-                        TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbxInstructionUnsigned(build, &dummy, globalCache, totemOperationType_MoveToGlobal));
+                        continue;
                     }
                 }
+                
+                totemOperandRegisterPrototype dummy;
+                dummy.RegisterIndex = (totemOperandXUnsigned)entry->Value;
+                dummy.RegisterScopeType = totemOperandType_LocalRegister;
+                
+                if (toLocal)
+                {
+                    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbxInstructionUnsigned(build, &dummy, globalCache, totemOperationType_MoveToLocal));
+                }
+                else
+                {
+                    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbxInstructionUnsigned(build, &dummy, globalCache, totemOperationType_MoveToGlobal));
+                }
             }
         }
     }
@@ -140,9 +138,12 @@ totemEvalStatus totemBuildPrototype_GlobalCacheCheck(totemBuildPrototype *build,
                 else
                 {
                     totemPublicDataType type;
+                    totemStructDeclarationPrototype *dec = NULL;
                     totemRegisterListPrototype_GetRegisterType(&build->GlobalRegisters, original.RegisterIndex, &type);
+                    totemRegisterListPrototype_GetRegisterStruct(&build->GlobalRegisters, original.RegisterIndex, &dec);
                     totemRegisterListPrototype_SetRegisterFlags(localScopeList, opOut->RegisterIndex, srcFlags | totemRegisterPrototypeFlag_IsGlobalCache);
                     totemRegisterListPrototype_SetRegisterType(localScopeList, opOut->RegisterIndex, type);
+                    totemRegisterListPrototype_SetRegisterStruct(localScopeList, opOut->RegisterIndex, dec);
                 }
             }
         }
@@ -162,6 +162,86 @@ totemEvalStatus totemForLoopPrototype_Eval(totemForLoopPrototype *forLoop, totem
     return totemEvalStatus_Success;
 }
 
+static totemEvalStatus totemForEachLoopPrototype_EvalVariable(totemVariablePrototype *variable, totemBuildPrototype *build, totemOperandRegisterPrototype *op)
+{
+    // loop variables declared at global scope outlive the loop, so a later loop may pick them up again
+    if (totemRegisterListPrototype_GetVariable(build->LocalVariableScope, &variable->Identifier, op, totemBool_True))
+    {
+        totemRegisterPrototypeFlag flags = totemRegisterPrototypeFlag_None;
+        totemRegisterListPrototype *existing = totemBuildPrototype_GetRegisterList(build, op->RegisterScopeType);
+        totemRegisterListPrototype_GetRegisterFlags(existing, op->RegisterIndex, &flags);
+        
+        if (TOTEM_HASBITS(flags, totemRegisterPrototypeFlag_IsConst) || TOTEM_HASBITS(variable->Flags, totemVariablePrototypeFlag_IsConst))
+        {
+            return totemBuildPrototype_Break(build, totemEvalStatus_IdentifierAlreadyDefined, &variable->Position);
+        }
+    }
+    else
+    {
+        TOTEM_EVAL_CHECKRETURN(totemVariablePrototype_Eval(variable, build, op));
+    }
+    
+    totemRegisterListPrototype *scope = totemBuildPrototype_GetRegisterList(build, op->RegisterScopeType);
+    totemRegisterListPrototype_SetRegisterFlags(scope, op->RegisterIndex, totemRegisterPrototypeFlag_IsAssigned);
+    return totemEvalStatus_Success;
+}
+
+totemEvalStatus totemForEachLoopPrototype_Eval(totemForEachLoopPrototype *forEachLoop, totemBuildPrototype *build)
+{
+    totemOperandRegisterPrototype src, collection, cursor, start, key, value, unused;
+    memset(&unused, 0, sizeof(unused));
+    
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EnterLocalScope(build));
+    
+    // hold on to the collection itself, so reassigning whatever it came from doesn't affect the loop
+    TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_Eval(forEachLoop->Collection, build, NULL, &src));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_AddRegister(build, totemOperandType_LocalRegister, &collection));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, &collection, &src, &unused, totemOperationType_Move));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &src));
+    
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_AddRegister(build, totemOperandType_LocalRegister, &cursor));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalInt(build, 0, &start, NULL));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, &cursor, &start, &unused, totemOperationType_Move));
+    
+    TOTEM_EVAL_CHECKRETURN(totemForEachLoopPrototype_EvalVariable(forEachLoop->Value, build, &value));
+    
+    // without a key variable, the key is written to the value's register & immediately overwritten
+    if (forEachLoop->Key)
+    {
+        TOTEM_EVAL_CHECKRETURN(totemForEachLoopPrototype_EvalVariable(forEachLoop->Key, build, &key));
+    }
+    else
+    {
+        memcpy(&key, &value, sizeof(totemOperandRegisterPrototype));
+    }
+    
+    totemEvalLoopPrototype loop;
+    totemEvalLoopPrototype_Begin(&loop, build);
+    totemEvalLoopPrototype_SetStartPosition(&loop, build);
+    
+    // Next takes up two words, the second holding the key register & the offset to the end of the loop
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbcInstruction(build, &cursor, &collection, &value, totemOperationType_Next));
+    size_t exitIndex = totemMemoryBuffer_GetNumObjects(&build->Instructions);
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalAbxInstructionSigned(build, &key, 0, totemOperationType_Next));
+    
+    for (totemStatementPrototype *statement = forEachLoop->StatementsStart; statement != NULL; statement = statement->Next)
+    {
+        TOTEM_EVAL_CHECKRETURN(totemStatementPrototype_Eval(statement, build));
+    }
+    
+    TOTEM_EVAL_CHECKRETURN(totemEvalLoopPrototype_Loop(&loop, build));
+    
+    totemInstruction *exitInstruction = totemMemoryBuffer_Get(&build->Instructions, exitIndex);
+    totemOperandXSigned exitOffset = (totemOperandXSigned)totemMemoryBuffer_GetNumObjects(&build->Instructions) - (totemOperandXSigned)exitIndex;
+    TOTEM_EVAL_CHECKRETURN(totemInstruction_SetBxSigned(exitInstruction, exitOffset));
+    
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &cursor));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_RecycleRegister(build, &collection));
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_ExitLocalScope(build));
+    
+    return totemEvalStatus_Success;
+}
+
 totemEvalStatus totemIfBlockPrototype_EvalIfBlock(totemIfBlockPrototype *ifBlock, totemEvalLoopPrototype *loop, totemBuildPrototype *build)
 {
     totemEvalLoopPrototype_Begin(loop, build);
@@ -313,6 +393,20 @@ totemEvalStatus totemForLoopPrototype_EvalValues(totemForLoopPrototype *loop, to
     return totemExpressionPrototype_EvalValues(loop->AfterThought, build);
 }
 
+totemEvalStatus totemForEachLoopPrototype_EvalValues(totemForEachLoopPrototype *loop, totemBuildPrototype *build)
+{
+    totemOperandRegisterPrototype dummy;
+    TOTEM_EVAL_CHECKRETURN(totemBuildPrototype_EvalInt(build, 0, &dummy, NULL));
+    TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_EvalValues(loop->Collection, build));
+    
+    for (totemStatementPrototype *stmt = loop->StatementsStart; stmt != NULL; stmt = stmt->Next)
+    {
+        TOTEM_EVAL_CHECKRETURN(totemStatementPrototype_EvalValues(stmt, build));
+    }
+    
+    return totemEvalStatus_Success;
+}
+
 totemEvalStatus totemIfBlockPrototype_EvalValues(totemIfBlockPrototype *loop, totemBuildPrototype *build)
 {
     TOTEM_EVAL_CHECKRETURN(totemExpressionPrototype_EvalValues(loop->Expression, build));
@@ -47,6 +47,7 @@ totemEvalStatus totemRegisterListPrototype_AddRegister(totemRegisterListPrototyp
     
     reg->Int = 0;
     reg->RefCount = 1;
+    reg->Struct = NULL;
     reg->GlobalCache = 0;
     reg->DataType = totemPublicDataType_Null;
     reg->Flags = totemRegisterPrototypeFlag_IsTemporary | totemRegisterPrototypeFlag_IsUsed;
@@ -136,6 +137,30 @@ totemBool totemRegisterListPrototype_SetRegisterType(totemRegisterListPrototype
     return totemBool_True;
 }
 
+totemBool totemRegisterListPrototype_GetRegisterStruct(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemStructDeclarationPrototype **dec)
+{
+    totemRegisterPrototype *reg = totemMemoryBuffer_Get(&list->Registers, index);
+    if (!reg || !TOTEM_HASBITS(reg->Flags, totemRegisterPrototypeFlag_IsUsed))
+    {
+        return totemBool_False;
+    }
+    
+    *dec = reg->Struct;
+    return reg->Struct != NULL;
+}
+
+totemBool totemRegisterListPrototype_SetRegisterStruct(totemRegisterListPrototype *list, totemOperandXUnsigned index, totemStructDeclarationPrototype *dec)
+{
+    totemRegisterPrototype *reg = totemMemoryBuffer_Get(&list->Registers, index);
+    if (!reg || !TOTEM_HASBITS(reg->Flags, totemRegisterPrototypeFlag_IsUsed))
+    {
+        return totemBool_False;
+    }
+    
+    reg->Struct = dec;
+    return totemBool_True;
+}
+
 totemBool totemRegisterListPrototype_DecRegisterRefCount(totemRegisterListPrototype *list, totemOperandXUnsigned index, size_t *countOut)
 {
     totemRegisterPrototype *reg = totemMemoryBuffer_Get(&list->Registers, index);
@@ -366,6 +391,24 @@ totemEvalStatus totemRegisterListPrototype_AddNull(totemRegisterListPrototype *l
     return totemEvalStatus_Success;
 }
 
+// templates are never shared between literals, even identical ones, as each is cloned separately anyway
+totemEvalStatus totemRegisterListPrototype_AddTemplate(totemRegisterListPrototype *list, totemPublicDataType type, totemOperandRegisterPrototype *op)
+{
+    totemEvalStatus status = totemRegisterListPrototype_AddRegister(list, op);
+    if (status != totemEvalStatus_Success)
+    {
+        return status;
+    }
+    
+    totemRegisterPrototype *reg = (totemRegisterPrototype*)totemMemoryBuffer_Get(&list->Registers, op->RegisterIndex);
+    
+    TOTEM_SETBITS(reg->Flags, totemRegisterPrototypeFlag_IsValue);
+    TOTEM_UNSETBITS(reg->Flags, totemRegisterPrototypeFlag_IsTemporary);
+    
+    reg->DataType = type;
+    return totemEvalStatus_Success;
+}
+
 totemEvalStatus totemRegisterListPrototype_AddBoolean(totemRegisterListPrototype *list, totemBool val, totemOperandRegisterPrototype *op)
 {
     val = val != totemBool_False;
@@ -518,18 +561,13 @@ void totemRegisterListPrototype_FreeScope(totemRegisterListPrototype *list)
 
 totemEvalStatus totemRegisterListPrototypeScope_FreeGlobalCache(totemRegisterListPrototypeScope *scope, totemRegisterListPrototype *list)
 {
-    for (size_t i = 0; i < scope->MoveToLocalVars.NumBuckets; i++)
+    size_t index = 0;
+    for (totemHashMapEntry *entry = totemHashMap_Iterate(&scope->MoveToLocalVars, &index); entry != NULL; entry = totemHashMap_Iterate(&scope->MoveToLocalVars, &index))
     {
-        totemHashMapEntry *bucket = scope->MoveToLocalVars.Buckets[i];
-        while (bucket)
-        {
-            totemOperandRegisterPrototype operand;
-            operand.RegisterIndex = (totemOperandXUnsigned)bucket->Value;
-            operand.RegisterScopeType = list->ScopeType;
-            TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_FreeRegister(list, &operand));
-            
-            bucket = bucket->Next;
-        }
+        totemOperandRegisterPrototype operand;
+        operand.RegisterIndex = (totemOperandXUnsigned)entry->Value;
+        operand.RegisterScopeType = list->ScopeType;
+        TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_FreeRegister(list, &operand));
     }
     
     return totemEvalStatus_Success;
@@ -537,18 +575,13 @@ totemEvalStatus totemRegisterListPrototypeScope_FreeGlobalCache(totemRegisterLis
 
 totemEvalStatus totemRegisterListPrototype_ExitScope(totemRegisterListPrototype *list)
 {
-    for (size_t i = 0; i < list->Scope->Identifiers.NumBuckets; i++)
+    size_t index = 0;
+    for (totemHashMapEntry *entry = totemHashMap_Iterate(&list->Scope->Identifiers, &index); entry != NULL; entry = totemHashMap_Iterate(&list->Scope->Identifiers, &index))
     {
-        totemHashMapEntry *bucket = list->Scope->Identifiers.Buckets[i];
-        while (bucket)
-        {
-            totemOperandRegisterPrototype operand;
-            operand.RegisterIndex = (totemOperandXUnsigned)bucket->Value;
-            operand.RegisterScopeType = list->ScopeType;
-            TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_FreeRegister(list, &operand));
-            
-            bucket = bucket->Next;
-        }
+        totemOperandRegisterPrototype operand;
+        operand.RegisterIndex = (totemOperandXUnsigned)entry->Value;
+        operand.RegisterScopeType = list->ScopeType;
+        TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototype_FreeRegister(list, &operand));
     }
     
     TOTEM_EVAL_CHECKRETURN(totemRegisterListPrototypeScope_FreeGlobalCache(list->Scope, list));
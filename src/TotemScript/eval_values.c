@@ -185,6 +185,10 @@ totemEvalStatus totemStatementPrototype_EvalValues(totemStatementPrototype *stat
             //build->Flags = prevFlags;
             break;
             
+        case totemStatementType_ForEachLoop:
+            status = totemForEachLoopPrototype_EvalValues(statement->ForEachLoop, build);
+            break;
+            
         case totemStatementType_IfBlock:
             //TOTEM_UNSETBITS(build->Flags, totemBuildPrototypeFlag_EvalVariables);
             status = totemIfBlockPrototype_EvalValues(statement->IfBlock, build);
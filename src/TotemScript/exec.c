@@ -53,9 +53,25 @@ void totemInstance_Cleanup(totemInstance *instance)
     totemMemoryBuffer_Cleanup(&instance->LocalFunctions);
 }
 
-void totemInternedStringHeader_Destroy(totemInternedStringHeader *str)
+void totemInternedStringHeader_Destroy(totemAllocator *allocator, totemInternedStringHeader *str)
 {
-    totem_CacheFree(str, sizeof(totemInternedStringHeader) + str->Length - 1);
+    totemAllocator_Free(allocator, str, sizeof(totemInternedStringHeader) + str->Length - 1);
+}
+
+void totemInternedStringHeader_Mark(totemInternedStringHeader *str, size_t epoch)
+{
+    // several exec states may be marking the same string at once, only ever move the epoch forwards
+    size_t current = totem_AtomicLoadSize(&str->Epoch);
+    while (current < epoch)
+    {
+        size_t prev = totem_AtomicCompareExchangeSize(&str->Epoch, current, epoch);
+        if (prev == current)
+        {
+            break;
+        }
+        
+        current = prev;
+    }
 }
 
 void totemScript_Init(totemScript *script)
@@ -64,6 +80,8 @@ void totemScript_Init(totemScript *script)
     totemMemoryBuffer_Init(&script->FunctionNames, sizeof(totemRegister));
     totemMemoryBuffer_Init(&script->GlobalRegisters, sizeof(totemRegister));
     totemMemoryBuffer_Init(&script->Instructions, sizeof(totemInstruction));
+    totemMemoryBuffer_Init(&script->Templates, sizeof(totemScriptTemplate));
+    totemMemoryBuffer_Init(&script->TemplateValues, sizeof(totemOperandXUnsigned));
     totemHashMap_Init(&script->FunctionNameLookup);
 }
 
@@ -73,6 +91,8 @@ void totemScript_Reset(totemScript *script)
     totemMemoryBuffer_Reset(&script->FunctionNames);
     totemMemoryBuffer_Reset(&script->GlobalRegisters);
     totemMemoryBuffer_Reset(&script->Instructions);
+    totemMemoryBuffer_Reset(&script->Templates);
+    totemMemoryBuffer_Reset(&script->TemplateValues);
     totemHashMap_Reset(&script->FunctionNameLookup);
 }
 
@@ -82,6 +102,8 @@ void totemScript_Cleanup(totemScript *script)
     totemMemoryBuffer_Cleanup(&script->FunctionNames);
     totemMemoryBuffer_Cleanup(&script->GlobalRegisters);
     totemMemoryBuffer_Cleanup(&script->Instructions);
+    totemMemoryBuffer_Cleanup(&script->Templates);
+    totemMemoryBuffer_Cleanup(&script->TemplateValues);
     totemHashMap_Cleanup(&script->FunctionNameLookup);
 }
 
@@ -102,8 +124,60 @@ void totemRuntime_Init(totemRuntime *runtime)
     totemMemoryBuffer_Init(&runtime->NativeFunctions, sizeof(totemNativeFunction));
     totemMemoryBuffer_Init(&runtime->NativeFunctionNames, sizeof(totemRegister));
     totemHashMap_Init(&runtime->NativeFunctionsLookup);
-    totemHashMap_Init(&runtime->InternedStrings);
-    totemLock_Init(&runtime->InternedStringsLock);
+    totemAllocator_InitDefault(&runtime->Allocator);
+    
+    for (size_t i = 0; i < TOTEM_RUNTIME_NUMSTRINGSHARDS; i++)
+    {
+        totemInternedStringShard *shard = &runtime->InternedStrings[i];
+        totemHashMap_Init(&shard->Strings);
+        totemLock_Init(&shard->Lock);
+        shard->Allocator = runtime->Allocator;
+        shard->Strings.Allocator = &shard->Allocator;
+    }
+    
+    totemLock_Init(&runtime->ExecStatesLock);
+    totemMemoryBuffer_Init(&runtime->ExecStates, sizeof(totemExecState*));
+    runtime->StringEpoch = 1;
+    runtime->StringSweepEpoch = 0;
+    
+    totemLock_Init(&runtime->FrozenLock);
+    totemMemoryBuffer_Init(&runtime->FrozenObjects, sizeof(totemGCObject*));
+    runtime->FrozenAllocator = runtime->Allocator;
+}
+
+void totemRuntime_SetAllocator(totemRuntime *runtime, totemAllocator *allocator)
+{
+    runtime->Allocator = *allocator;
+    totemAllocator_ResetStats(&runtime->Allocator);
+    
+    // each shard allocates under its own lock, so the allocator may be called from several threads at once
+    for (size_t i = 0; i < TOTEM_RUNTIME_NUMSTRINGSHARDS; i++)
+    {
+        runtime->InternedStrings[i].Allocator = runtime->Allocator;
+    }
+    
+    runtime->FrozenAllocator = runtime->Allocator;
+}
+
+void totemRuntime_GetMemoryUsage(totemRuntime *runtime, size_t *numBytesOut, size_t *peakBytesOut)
+{
+    *numBytesOut = 0;
+    *peakBytesOut = 0;
+    
+    for (size_t i = 0; i < TOTEM_RUNTIME_NUMSTRINGSHARDS; i++)
+    {
+        totemInternedStringShard *shard = &runtime->InternedStrings[i];
+        
+        totemLock_Acquire(&shard->Lock);
+        *numBytesOut += shard->Allocator.NumBytes;
+        *peakBytesOut += shard->Allocator.PeakBytes;
+        totemLock_Release(&shard->Lock);
+    }
+    
+    totemLock_Acquire(&runtime->FrozenLock);
+    *numBytesOut += runtime->FrozenAllocator.NumBytes;
+    *peakBytesOut += runtime->FrozenAllocator.PeakBytes;
+    totemLock_Release(&runtime->FrozenLock);
 }
 
 void totemRuntime_Reset(totemRuntime *runtime)
@@ -111,8 +185,38 @@ void totemRuntime_Reset(totemRuntime *runtime)
     totemMemoryBuffer_Reset(&runtime->NativeFunctions);
     totemMemoryBuffer_Reset(&runtime->NativeFunctionNames);
     totemHashMap_Reset(&runtime->NativeFunctionsLookup);
-    totemHashMap_Reset(&runtime->InternedStrings);
-    totemLock_Release(&runtime->InternedStringsLock);
+    
+    for (size_t s = 0; s < TOTEM_RUNTIME_NUMSTRINGSHARDS; s++)
+    {
+        totemInternedStringShard *shard = &runtime->InternedStrings[s];
+        
+        totemLock_Acquire(&shard->Lock);
+        
+        size_t index = 0;
+        for(totemHashMapEntry *entry = totemHashMap_Iterate(&shard->Strings, &index); entry != NULL; entry = totemHashMap_Iterate(&shard->Strings, &index))
+        {
+            totemInternedStringHeader *hdr = (totemInternedStringHeader*)entry->Value;
+            if(hdr)
+            {
+                totemInternedStringHeader_Destroy(&shard->Allocator, hdr);
+            }
+        }
+        
+        totemHashMap_Reset(&shard->Strings);
+        totemLock_Release(&shard->Lock);
+    }
+    
+    // detach any exec states still linked to us
+    totemLock_Acquire(&runtime->ExecStatesLock);
+    
+    for (size_t i = 0; i < totemMemoryBuffer_GetNumObjects(&runtime->ExecStates); i++)
+    {
+        totemExecState **state = totemMemoryBuffer_Get(&runtime->ExecStates, i);
+        (*state)->Runtime = NULL;
+    }
+    
+    totemMemoryBuffer_Reset(&runtime->ExecStates);
+    totemLock_Release(&runtime->ExecStatesLock);
 }
 
 void totemRuntime_Cleanup(totemRuntime *runtime)
@@ -122,47 +226,63 @@ void totemRuntime_Cleanup(totemRuntime *runtime)
     totemHashMap_Cleanup(&runtime->NativeFunctionsLookup);
     
     // clean up interned strings
-    for(size_t i = 0; i < runtime->InternedStrings.NumBuckets; i++)
+    for (size_t s = 0; s < TOTEM_RUNTIME_NUMSTRINGSHARDS; s++)
     {
-        for(totemHashMapEntry *entry = runtime->InternedStrings.Buckets[i]; entry != NULL; entry = entry->Next)
+        totemInternedStringShard *shard = &runtime->InternedStrings[s];
+        
+        size_t index = 0;
+        for(totemHashMapEntry *entry = totemHashMap_Iterate(&shard->Strings, &index); entry != NULL; entry = totemHashMap_Iterate(&shard->Strings, &index))
         {
             totemInternedStringHeader *hdr = (totemInternedStringHeader*)entry->Value;
             if(hdr)
             {
-                totemInternedStringHeader_Destroy(hdr);
+                totemInternedStringHeader_Destroy(&shard->Allocator, hdr);
             }
         }
+        
+        totemHashMap_Cleanup(&shard->Strings);
+        totemLock_Cleanup(&shard->Lock);
     }
     
-    totemHashMap_Cleanup(&runtime->InternedStrings);
-    totemLock_Cleanup(&runtime->InternedStringsLock);
-}
-
-totemLinkStatus totemRuntime_InternString(totemRuntime *runtime, totemString *str, totemRuntimeStringValue *valOut)
-{
-    if(str->Length <= TOTEM_MINISTRING_MAXLENGTH)
+    // detach any exec states still linked to us
+    for (size_t i = 0; i < totemMemoryBuffer_GetNumObjects(&runtime->ExecStates); i++)
     {
-        valOut->Type = totemPrivateDataType_MiniString;
-        memset(valOut->MiniString, 0, sizeof(valOut->MiniString));
-        memcpy(valOut->MiniString, str->Value, str->Length);
-        
-        return totemLinkStatus_Success;
+        totemExecState **state = totemMemoryBuffer_Get(&runtime->ExecStates, i);
+        (*state)->Runtime = NULL;
     }
     
+    totemMemoryBuffer_Cleanup(&runtime->ExecStates);
+    totemLock_Cleanup(&runtime->ExecStatesLock);
+    
+    for (size_t i = 0; i < totemMemoryBuffer_GetNumObjects(&runtime->FrozenObjects); i++)
+    {
+        totemGCObject **gc = totemMemoryBuffer_Get(&runtime->FrozenObjects, i);
+        totemRuntime_DestroyFrozenObject(runtime, *gc);
+    }
+    
+    totemMemoryBuffer_Cleanup(&runtime->FrozenObjects);
+    totemLock_Cleanup(&runtime->FrozenLock);
+}
+
+static totemLinkStatus totemRuntime_InternPrecomputed(totemRuntime *runtime, totemString *str, totemHash hash, totemRuntimeStringValue *valOut, totemBool pin)
+{
     totemLinkStatus status = totemLinkStatus_Success;
-    totemLock_Acquire(&runtime->InternedStringsLock);
+    totemInternedStringShard *shard = &runtime->InternedStrings[TOTEM_RUNTIME_STRINGSHARD(hash)];
     
-    totemHashMapEntry *result = totemHashMap_Find(&runtime->InternedStrings, str->Value, str->Length);
+    totemLock_Acquire(&shard->Lock);
+    
+    totemHashMapEntry *result = totemHashMap_FindPrecomputed(&shard->Strings, str->Value, str->Length, hash);
     if(result)
     {
         valOut->Type = totemPrivateDataType_InternedString;
         valOut->InternedString = (totemInternedStringHeader*)result->Value;
+        totemInternedStringHeader_Mark(valOut->InternedString, pin ? TOTEM_INTERNEDSTRING_PINNED : totem_AtomicLoadSize(&runtime->StringEpoch));
     }
     else
     {
         size_t toAllocate = str->Length + sizeof(totemInternedStringHeader) - 1;
         
-        totemInternedStringHeader *newStr = totem_CacheMalloc(toAllocate);
+        totemInternedStringHeader *newStr = totemAllocator_Alloc(&shard->Allocator, toAllocate);
         if (!newStr)
         {
             status = totemLinkStatus_OutOfMemory;
@@ -170,14 +290,15 @@ totemLinkStatus totemRuntime_InternString(totemRuntime *runtime, totemString *st
         else
         {
             newStr->Length = str->Length;
+            newStr->Epoch = pin ? TOTEM_INTERNEDSTRING_PINNED : totem_AtomicLoadSize(&runtime->StringEpoch);
             
-            newStr->Hash = totem_Hash(str->Value, newStr->Length);
+            newStr->Hash = hash;
             memcpy(newStr->Data, str->Value, newStr->Length);
             newStr->Data[newStr->Length] = 0;
             
-            if (!totemHashMap_InsertPrecomputed(&runtime->InternedStrings, newStr->Data, newStr->Length, (uintptr_t)newStr, newStr->Hash))
+            if (!totemHashMap_InsertPrecomputedWithoutSearch(&shard->Strings, newStr->Data, newStr->Length, (uintptr_t)newStr, newStr->Hash))
             {
-                totemInternedStringHeader_Destroy(newStr);
+                totemInternedStringHeader_Destroy(&shard->Allocator, newStr);
                 status = totemLinkStatus_OutOfMemory;
             }
             else
@@ -188,7 +309,7 @@ totemLinkStatus totemRuntime_InternString(totemRuntime *runtime, totemString *st
         }
     }
     
-    totemLock_Release(&runtime->InternedStringsLock);
+    totemLock_Release(&shard->Lock);
     
     if (status != totemLinkStatus_Success)
     {
@@ -198,6 +319,70 @@ totemLinkStatus totemRuntime_InternString(totemRuntime *runtime, totemString *st
     return status;
 }
 
+totemLinkStatus totemRuntime_InternString(totemRuntime *runtime, totemString *str, totemRuntimeStringValue *valOut)
+{
+    if(str->Length <= TOTEM_MINISTRING_MAXLENGTH)
+    {
+        valOut->Type = totemPrivateDataType_MiniString;
+        memset(valOut->MiniString, 0, sizeof(valOut->MiniString));
+        memcpy(valOut->MiniString, str->Value, str->Length);
+        
+        return totemLinkStatus_Success;
+    }
+    
+    return totemRuntime_InternPrecomputed(runtime, str, totem_Hash(str->Value, str->Length), valOut, totemBool_True);
+}
+
+// exec states lock must be held
+static size_t totemRuntime_SweepInternedStrings(totemRuntime *runtime, size_t epoch)
+{
+    size_t numFreed = 0;
+    
+    for (size_t s = 0; s < TOTEM_RUNTIME_NUMSTRINGSHARDS; s++)
+    {
+        totemInternedStringShard *shard = &runtime->InternedStrings[s];
+        
+        totemLock_Acquire(&shard->Lock);
+        
+        // removal leaves the slot behind as a tombstone, so iteration can carry on past it
+        size_t index = 0;
+        for (totemHashMapEntry *entry = totemHashMap_Iterate(&shard->Strings, &index); entry != NULL; entry = totemHashMap_Iterate(&shard->Strings, &index))
+        {
+            totemInternedStringHeader *hdr = (totemInternedStringHeader*)entry->Value;
+            if (totem_AtomicLoadSize(&hdr->Epoch) < epoch)
+            {
+                totemHashMap_RemovePrecomputed(&shard->Strings, hdr->Data, hdr->Length, hdr->Hash);
+                totemInternedStringHeader_Destroy(&shard->Allocator, hdr);
+                numFreed++;
+            }
+        }
+        
+        totemLock_Release(&shard->Lock);
+    }
+    
+    return numFreed;
+}
+
+static void totemRuntime_UnlinkExecState(totemRuntime *runtime, totemExecState *state)
+{
+    totemLock_Acquire(&runtime->ExecStatesLock);
+    
+    size_t num = totemMemoryBuffer_GetNumObjects(&runtime->ExecStates);
+    for (size_t i = 0; i < num; i++)
+    {
+        totemExecState **current = totemMemoryBuffer_Get(&runtime->ExecStates, i);
+        if (*current == state)
+        {
+            totemExecState **last = totemMemoryBuffer_Top(&runtime->ExecStates);
+            *current = *last;
+            totemMemoryBuffer_Pop(&runtime->ExecStates, 1);
+            break;
+        }
+    }
+    
+    totemLock_Release(&runtime->ExecStatesLock);
+}
+
 totemLinkStatus totemRuntime_LinkBuild(totemRuntime *runtime, totemBuildPrototype *build, totemScript *script)
 {
     totemScript_Reset(script);
@@ -349,11 +534,35 @@ totemLinkStatus totemRuntime_LinkBuild(totemRuntime *runtime, totemBuildPrototyp
                 totemRegister_SetNull(reg);
                 break;
                 
+                // built by each instance
+            case totemPublicDataType_Array:
+            case totemPublicDataType_Object:
+                totemRegister_SetNull(reg);
+                break;
+                
             default:
                 return totemLinkStatus_Break(totemLinkStatus_UnexpectedValueType);
         }
     }
     
+    // literal templates
+    size_t numTemplates = totemMemoryBuffer_GetNumObjects(&build->Templates);
+    if (!totemMemoryBuffer_Secure(&script->Templates, numTemplates) || !totemMemoryBuffer_TakeFrom(&script->TemplateValues, &build->TemplateValues))
+    {
+        return totemLinkStatus_Break(totemLinkStatus_OutOfMemory);
+    }
+    
+    for (size_t i = 0; i < numTemplates; i++)
+    {
+        totemTemplatePrototype *prototype = totemMemoryBuffer_Get(&build->Templates, i);
+        totemScriptTemplate *scriptTemplate = totemMemoryBuffer_Get(&script->Templates, i);
+        
+        scriptTemplate->Register = prototype->Register;
+        scriptTemplate->Type = prototype->Type;
+        scriptTemplate->ValuesStart = prototype->ValuesStart;
+        scriptTemplate->NumValues = prototype->NumValues;
+    }
+    
     return totemLinkStatus_Success;
 }
 
@@ -455,16 +664,41 @@ totemBool totemRuntime_GetNativeFunctionName(totemRuntime *runtime, totemOperand
 
 totemLinkStatus totemRuntime_LinkExecState(totemRuntime *runtime, totemExecState *state, size_t numRegisters)
 {
+    if (state->Runtime != runtime)
+    {
+        if (state->Runtime)
+        {
+            totemRuntime_UnlinkExecState(state->Runtime, state);
+        }
+        
+        totemLock_Acquire(&runtime->ExecStatesLock);
+        
+        if (!totemMemoryBuffer_Insert(&runtime->ExecStates, &state, 1))
+        {
+            totemLock_Release(&runtime->ExecStatesLock);
+            return totemLinkStatus_Break(totemLinkStatus_OutOfMemory);
+        }
+        
+#if TOTEM_GCTYPE_ISMARKANDSWEEP
+        // a fresh state can only pick up strings by interning them, which stamps them with the current epoch
+        state->StringMarkEpoch = runtime->StringEpoch;
+        state->StringSafeEpoch = runtime->StringEpoch;
+#endif
+        totemLock_Release(&runtime->ExecStatesLock);
+        
+        memset(state->StringCache, 0, sizeof(state->StringCache));
+    }
+    
     state->Runtime = runtime;
     
     if (state->LocalRegisters)
     {
-        totem_CacheFree(state->LocalRegisters, sizeof(totemRegister) * state->MaxLocalRegisters);
+        totemAllocator_Free(&state->Allocator, state->LocalRegisters, sizeof(totemRegister) * state->MaxLocalRegisters);
     }
     
     if (numRegisters > 0)
     {
-        totemRegister *regs = totem_CacheMalloc(sizeof(totemRegister) * numRegisters);
+        totemRegister *regs = totemAllocator_Alloc(&state->Allocator, sizeof(totemRegister) * numRegisters);
         
         if (!regs)
         {
@@ -490,18 +724,29 @@ totemExecStatus totemExecStatus_Break(totemExecStatus status)
     return status;
 }
 
+void totemExecState_SetAllocator(totemExecState *state, totemAllocator *allocator)
+{
+    state->Allocator = *allocator;
+    totemAllocator_ResetStats(&state->Allocator);
+}
+
 void *totemExecState_Alloc(totemExecState *state, size_t size)
 {
-    void *ptr = totem_CacheMalloc(size);
+    void *ptr = totemAllocator_Alloc(&state->Allocator, size);
     if (!ptr)
     {
         totemExecState_CollectGarbage(state, totemBool_True);
-        ptr = totem_CacheMalloc(size);
+        ptr = totemAllocator_Alloc(&state->Allocator, size);
     }
     
     return ptr;
 }
 
+void totemExecState_Free(totemExecState *state, void *ptr, size_t size)
+{
+    totemAllocator_Free(&state->Allocator, ptr, size);
+}
+
 totemFunctionCall *totemExecState_SecureFunctionCall(totemExecState *state)
 {
     totemFunctionCall *call = NULL;
@@ -531,13 +776,101 @@ void totemExecState_FreeFunctionCall(totemExecState *state, totemFunctionCall *c
     state->CallStackFreeList = call;
 }
 
+#if TOTEM_GCTYPE_ISMARKANDSWEEP
+
+void totemExecState_BeginStringMark(totemExecState *state)
+{
+    totemRuntime *runtime = state->Runtime;
+    if (!runtime)
+    {
+        return;
+    }
+    
+    totemLock_Acquire(&runtime->ExecStatesLock);
+    size_t epoch = runtime->StringEpoch;
+    state->StringMarkEpoch = epoch + 1;
+    
+    // interning reads the epoch without taking this lock
+    totem_AtomicCompareExchangeSize(&runtime->StringEpoch, epoch, epoch + 1);
+    totemLock_Release(&runtime->ExecStatesLock);
+}
+
+void totemExecState_FinishStringMark(totemExecState *state)
+{
+    totemRuntime *runtime = state->Runtime;
+    if (!runtime)
+    {
+        return;
+    }
+    
+    // the front cache hands strings out without going back to the runtime, so its contents have to stay alive too
+    for (size_t i = 0; i < TOTEM_EXEC_STRINGCACHESIZE; i++)
+    {
+        if (state->StringCache[i])
+        {
+            totemInternedStringHeader_Mark(state->StringCache[i], state->StringMarkEpoch);
+        }
+    }
+    
+    totemLock_Acquire(&runtime->ExecStatesLock);
+    
+    // anything reachable from this state has now been stamped with at least StringMarkEpoch
+    state->StringSafeEpoch = state->StringMarkEpoch;
+    
+    // strings older than every state's last completed mark can't be reached by any of them
+    size_t safeEpoch = TOTEM_INTERNEDSTRING_PINNED;
+    for (size_t i = 0; i < totemMemoryBuffer_GetNumObjects(&runtime->ExecStates); i++)
+    {
+        totemExecState **other = totemMemoryBuffer_Get(&runtime->ExecStates, i);
+        if ((*other)->StringSafeEpoch < safeEpoch)
+        {
+            safeEpoch = (*other)->StringSafeEpoch;
+        }
+    }
+    
+    if (safeEpoch != TOTEM_INTERNEDSTRING_PINNED && safeEpoch > runtime->StringSweepEpoch)
+    {
+        totemRuntime_SweepInternedStrings(runtime, safeEpoch);
+        runtime->StringSweepEpoch = safeEpoch;
+    }
+    
+    totemLock_Release(&runtime->ExecStatesLock);
+}
+
+#endif
+
 totemExecStatus totemExecState_InternString(totemExecState *state, totemString *str, totemRegister *strOut)
 {
     totemRuntimeStringValue newStr;
     
-    if (totemRuntime_InternString(state->Runtime, str, &newStr) != totemLinkStatus_Success)
+    if (str->Length <= TOTEM_MINISTRING_MAXLENGTH)
     {
-        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        if (totemRuntime_InternString(state->Runtime, str, &newStr) != totemLinkStatus_Success)
+        {
+            return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        }
+        
+        totemExecState_AssignNewString(state, strOut, &newStr);
+        return totemExecStatus_Continue;
+    }
+    
+    // check the front cache before touching the shared table
+    totemHash hash = totem_Hash(str->Value, str->Length);
+    totemInternedStringHeader **cached = &state->StringCache[hash % TOTEM_EXEC_STRINGCACHESIZE];
+    
+    if (*cached && (*cached)->Hash == hash && (*cached)->Length == str->Length && memcmp((*cached)->Data, str->Value, str->Length) == 0)
+    {
+        newStr.Type = totemPrivateDataType_InternedString;
+        newStr.InternedString = *cached;
+    }
+    else
+    {
+        if (totemRuntime_InternPrecomputed(state->Runtime, str, hash, &newStr, totemBool_False) != totemLinkStatus_Success)
+        {
+            return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        }
+        
+        *cached = newStr.InternedString;
     }
     
     totemExecState_AssignNewString(state, strOut, &newStr);
@@ -555,6 +888,7 @@ void totemExecState_CleanupRegisterList(totemExecState *state, totemRegister *re
 void totemExecState_Init(totemExecState *state)
 {
     memset(state, 0, sizeof(*state));
+    totemAllocator_InitDefault(&state->Allocator);
     totemExecState_InitGC(state);
     state->GCByteThreshold = 1024 * 1024;
 }
@@ -577,7 +911,7 @@ void totemExecState_Cleanup(totemExecState *state)
     for (totemFunctionCall *call = state->CallStackFreeList; call; )
     {
         totemFunctionCall *next = call->Prev;
-        totem_CacheFree(call, sizeof(totemFunctionCall));
+        totemExecState_Free(state, call, sizeof(totemFunctionCall));
         call = next;
     }
     
@@ -587,15 +921,21 @@ void totemExecState_Cleanup(totemExecState *state)
     for (totemGCObject *gc = state->GCFreeList; gc;)
     {
         totemGCObject *next = gc->Header.NextObj;
-        totem_CacheFree(gc, sizeof(totemGCObject));
+        totemExecState_Free(state, gc, sizeof(totemGCObject));
         gc = next;
     }
     
     state->GCFreeList = NULL;
     
     // cleanup local stack
-    totem_CacheFree(state->LocalRegisters, sizeof(totemRegister) * state->MaxLocalRegisters);
+    totemExecState_Free(state, state->LocalRegisters, sizeof(totemRegister) * state->MaxLocalRegisters);
     state->LocalRegisters = NULL;
+    
+    if (state->Runtime)
+    {
+        totemRuntime_UnlinkExecState(state->Runtime, state);
+        state->Runtime = NULL;
+    }
 }
 
 totemExecStatus totemExecState_CreateSubroutine(totemExecState *state, uint8_t numRegisters, totemGCObject *instance, totemRegister *returnReg, totemFunctionType funcType, void *function, totemFunctionCall **callOut)
@@ -701,7 +1041,7 @@ void totemExecState_PopRoutine(totemExecState *state)
         
         if (TOTEM_HASBITS(call->Flags, totemFunctionCallFlag_FreeStack))
         {
-            totem_CacheFree(call->FrameStart, sizeof(totemRegister) * call->NumRegisters);
+            totemExecState_Free(state, call->FrameStart, sizeof(totemRegister) * call->NumRegisters);
         }
         else
         {
@@ -750,6 +1090,89 @@ totemExecStatus totemExecState_Exec(totemExecState *state, totemInstanceFunction
     return node.Status;
 }
 
+totemExecStatus totemExecState_Call(totemExecState *state, totemRegister *function, totemRegister *args, uint8_t numArgs, totemRegister *dst)
+{
+    totemFunctionCall *retain = state->CallStack;
+    totemRegister *globals = state->GlobalRegisters;
+    totemFunctionCall *call = NULL;
+    totemExecStatus status = totemExecStatus_Continue;
+    
+    if (totemRegister_IsNativeFunction(function))
+    {
+        status = totemExecState_CreateSubroutine(state, numArgs, retain->Instance, dst, totemFunctionType_Native, totemRegister_GetNativeFunction(function), &call);
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+        
+        totemExecState_PushRoutine(state, call, NULL);
+        
+        // natives expect strings to be interned & nul-terminated
+        for (call->NumArguments = 0; call->NumArguments < numArgs; call->NumArguments++)
+        {
+            totemRegister *arg = &call->FrameStart[call->NumArguments];
+            totemExecState_Assign(state, arg, &args[call->NumArguments]);
+            
+            status = totemExecState_FlattenString(state, arg, arg);
+            if (status != totemExecStatus_Continue)
+            {
+                totemExecState_PopRoutine(state);
+                return status;
+            }
+        }
+        
+        status = call->NativeFunction->Callback(state);
+        totemExecState_PopRoutine(state);
+        return status;
+    }
+    
+    if (!totemRegister_IsInstanceFunction(function))
+    {
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemInstanceFunction *func = totemRegister_GetInstanceFunction(function);
+    uint8_t numRegisters = numArgs <= func->Function->RegistersNeeded ? func->Function->RegistersNeeded : numArgs;
+    
+    status = totemExecState_CreateSubroutine(state, numRegisters, func->Instance, dst, totemFunctionType_Script, func, &call);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    TOTEM_SETBITS(call->Flags, totemFunctionCallFlag_ReturnToNative);
+    
+    for (call->NumArguments = 0; call->NumArguments < numArgs; call->NumArguments++)
+    {
+        totemExecState_Assign(state, &call->FrameStart[call->NumArguments], &args[call->NumArguments]);
+    }
+    
+    totemExecState_PushRoutine(state, call, func->Function->InstructionsStart);
+    
+    // errors unwind back to here, rather than past the native function that made the call
+    totemJmpNode node;
+    node.Status = totemExecStatus_Continue;
+    node.Prev = state->JmpNode;
+    state->JmpNode = &node;
+    
+    TOTEM_JMP_TRY(node.Buffer)
+    {
+        totemExecState_ExecuteInstructions(state);
+        totemExecState_PopRoutine(state);
+    }
+    TOTEM_JMP_CATCH(node.Buffer)
+    {
+        while (state->CallStack != retain)
+        {
+            totemExecState_PopRoutine(state);
+        }
+    }
+    
+    state->JmpNode = node.Prev;
+    state->GlobalRegisters = globals;
+    return node.Status;
+}
+
 const char *totemExecStatus_Describe(totemExecStatus status)
 {
     switch(status)
@@ -768,6 +1191,8 @@ const char *totemExecStatus_Describe(totemExecStatus status)
             TOTEM_STRINGIFY_CASE(totemExecStatus_RefCountOverflow);
             TOTEM_STRINGIFY_CASE(totemExecStatus_DivideByZero);
             TOTEM_STRINGIFY_CASE(totemExecStatus_InternalBufferOverrun);
+            TOTEM_STRINGIFY_CASE(totemExecStatus_FrozenValueModified);
+            TOTEM_STRINGIFY_CASE(totemExecStatus_ExternalValueResized);
             TOTEM_STRINGIFY_CASE(totemExecStatus_InvalidKey);
             TOTEM_STRINGIFY_CASE(totemExecStatus_InvalidDispatch);
     }
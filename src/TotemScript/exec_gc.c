@@ -470,7 +470,8 @@ void totemExecState_AppendNewGCObject(totemExecState *state, totemGCObject *gc)
 
 void totemExecState_WriteBarrier(totemExecState *state, totemGCObject *gc)
 {
-    if (!TOTEM_HASBITS(gc->MarkFlags, totemGCObjectMarkSweepFlag_IsGrey))
+    // frozen objects are never written to, and their flags may be read from other threads
+    if (!TOTEM_GETBITS(gc->MarkFlags, totemGCObjectMarkSweepFlag_IsGrey | totemGCObjectMarkSweepFlag_IsFrozen))
     {
         TOTEM_GC_LOG(printf("Write barrier %p\n", gc));
         totemGCObject_Assert(gc);
@@ -488,14 +489,38 @@ void totemExecState_TraverseRegisterList(totemExecState *state, totemRegister *r
     for (size_t i = 0; i < num; i++)
     {
         totemRegister *reg = &regs[i];
-        if (totemRegister_IsGarbageCollected(reg))
+        if (totemRegister_IsInternedString(reg))
+        {
+            totemInternedStringHeader_Mark(totemRegister_GetInternedString(reg), state->StringMarkEpoch);
+        }
+        else if (totemRegister_IsGarbageCollected(reg))
         {
             obj = totemRegister_GetGCObject(reg);
+            
+            // frozen objects belong to the runtime & only hold pinned strings, so there's nothing to mark
+            if (TOTEM_GCOBJECT_ISFROZEN(obj))
+            {
+                continue;
+            }
+            
             totemGCObject_Assert(obj);
             if (!totemExecState_HasMark(state, obj))
             {
                 totemExecState_SetMark(state, obj);
                 
+                if (obj->Type == totemGCObjectType_Rope)
+                {
+                    if (obj->Rope->Source)
+                    {
+                        totemInternedStringHeader_Mark(obj->Rope->Source, state->StringMarkEpoch);
+                    }
+                    
+                    if (obj->Rope->Flattened)
+                    {
+                        totemInternedStringHeader_Mark(obj->Rope->Flattened, state->StringMarkEpoch);
+                    }
+                }
+                
                 if (obj->NumRegisters)
                 {
                     totemGCObject_Assert(obj);
@@ -521,7 +546,22 @@ void totemExecState_TraverseRegisterList(totemExecState *state, totemRegister *r
 
 totemGCObject *totemExecState_TraverseGCObject(totemExecState *state, totemGCObject *obj)
 {
-    totemExecState_TraverseRegisterList(state, obj->Registers, obj->NumRegisters);
+    if (obj->Type == totemGCObjectType_Array && obj->ArrayStore)
+    {
+        // views keep the array they borrow from alive, which covers every register they can see
+        totemGCObject *store = obj->ArrayStore;
+        if (!TOTEM_GCOBJECT_ISFROZEN(store) && !totemExecState_HasMark(state, store))
+        {
+            totemExecState_SetMark(state, store);
+            totemGCObject_Assert(store);
+            totemExecState_MoveGrey(state, store);
+            totemGCObject_Assert(store);
+        }
+    }
+    else
+    {
+        totemExecState_TraverseRegisterList(state, obj->Registers, obj->NumRegisters);
+    }
     
     totemGCObject *next = obj->Header.NextObj;
     
@@ -570,6 +610,7 @@ size_t totemExecState_MarkSweepStep(totemExecState *state)
             TOTEM_GC_LOG(printf("MARK AND SWEEP STATE RESET\n"));
             
             // mark roots grey
+            totemExecState_BeginStringMark(state);
             amount += totemExecState_MoveRootsGrey(state);
             state->GCState = totemMarkSweepState_Mark;
             break;
@@ -615,6 +656,9 @@ size_t totemExecState_MarkSweepStep(totemExecState *state)
                 //TOTEM_GC_LOG(printf("Flipping bit: %i\n", state->GCCurrentBit));
                 state->GCCurrentBit = !state->GCCurrentBit;
                 TOTEM_GC_LOG(printf("Flipping bit: %i\n", state->GCCurrentBit));
+                
+                // interned strings are held weakly by the runtime, drop any nobody reached
+                totemExecState_FinishStringMark(state);
                 state->GCState = totemMarkSweepState_Sweep;
             }
             break;
@@ -722,7 +766,7 @@ totemGCObject *totemExecState_CreateGCObject(totemExecState *state, totemGCObjec
         hdr->Registers = totemExecState_Alloc(state, sizeof(totemRegister) * numRegisters);
         if (!hdr->Registers)
         {
-            totem_CacheFree(hdr, sizeof(totemGCObject));
+            totemExecState_Free(state, hdr, sizeof(totemGCObject));
             return NULL;
         }
         
@@ -763,7 +807,7 @@ totemBool totemExecState_ExpandGCObject(totemExecState *state, totemGCObject *ob
     memcpy(newRegs, obj->Registers, sizeof(totemRegister) * obj->NumRegisters);
     totemRegister_InitList(newRegs + obj->NumRegisters, newNumRegisters - obj->NumRegisters);
     
-    totem_CacheFree(obj->Registers, sizeof(totemRegister) * obj->NumRegisters);
+    totemExecState_Free(state, obj->Registers, sizeof(totemRegister) * obj->NumRegisters);
     
     state->GCNumBytes -= (sizeof(totemRegister) * obj->NumRegisters);
     state->GCNumBytes += (sizeof(totemRegister) * newNumRegisters);
@@ -799,6 +843,14 @@ totemGCObject *totemExecState_DestroyGCObject(totemExecState *state, totemGCObje
             totemExecState_DestroyInstance(state, obj->Instance);
             break;
             
+        case totemGCObjectType_Rope:
+            totemExecState_DestroyRope(state, obj->Rope);
+            break;
+            
+        case totemGCObjectType_TypedArray:
+            totemExecState_DestroyTypedArray(state, obj->TypedArray);
+            break;
+            
         case totemGCObjectType_Deleting:
             return NULL;
             
@@ -806,14 +858,24 @@ totemGCObject *totemExecState_DestroyGCObject(totemExecState *state, totemGCObje
             break;
     }
     
-    if (obj->Registers)
+    // views don't own their registers, the array they borrow from may already be gone
+    if (obj->Registers && !(type == totemGCObjectType_Array && obj->ArrayStore))
     {
         totemExecState_CleanupRegisterList(state, obj->Registers, obj->NumRegisters);
     }
     
+    // arrays may have more registers allocated than they use
+    size_t numAllocated = type == totemGCObjectType_Array ? obj->ArrayCapacity : obj->NumRegisters;
+    
+    // userdata shares this pointer, but never has registers
+    if (numAllocated)
+    {
+        totemExecState_Free(state, obj->Registers, sizeof(totemRegister) * numAllocated);
+    }
+    
     //TOTEM_GC_LOG(printf("unlinking %i %p %s %p %p\n", state->GCNum, obj, totemGCObjectType_Describe(obj->Type), obj->Header.NextHdr, obj->Header.PrevHdr));
     
-    state->GCNumBytes -= sizeof(totemGCObject) + (sizeof(totemRegister) * obj->NumRegisters);
+    state->GCNumBytes -= sizeof(totemGCObject) + (sizeof(totemRegister) * numAllocated);
     
     totemGCObject *next = obj->Header.NextObj;
     totemGCHeader_Unlink(&obj->Header);
@@ -846,6 +908,8 @@ totemExecStatus totemExecState_CreateArray(totemExecState *state, totemInt numRe
         return totemExecStatus_Break(totemExecStatus_OutOfMemory);
     }
     
+    obj->ArrayCapacity = (size_t)numRegisters;
+    obj->ArrayStore = NULL;
     *gcOut = obj;
     return totemExecStatus_Continue;
 }
@@ -866,24 +930,280 @@ totemExecStatus totemExecState_CreateArrayFromExisting(totemExecState *state, to
     return totemExecStatus_Continue;
 }
 
+totemExecStatus totemExecState_ReserveArray(totemExecState *state, totemGCObject *gc, size_t capacity)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(gc))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
+    
+    totemExecStatus status = totemExecState_UnshareArray(state, gc);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    if (capacity <= gc->ArrayCapacity)
+    {
+        return totemExecStatus_Continue;
+    }
+    
+    if (capacity >= UINT32_MAX)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    totemRegister *newRegs = totemExecState_Alloc(state, sizeof(totemRegister) * capacity);
+    if (!newRegs)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    // a straight move, so no reference counts change hands
+    if (gc->ArrayCapacity)
+    {
+        memcpy(newRegs, gc->Registers, sizeof(totemRegister) * gc->NumRegisters);
+        totemExecState_Free(state, gc->Registers, sizeof(totemRegister) * gc->ArrayCapacity);
+    }
+    
+    totemRegister_InitList(newRegs + gc->NumRegisters, capacity - gc->NumRegisters);
+    
+    state->GCNumBytes -= (sizeof(totemRegister) * gc->ArrayCapacity);
+    state->GCNumBytes += (sizeof(totemRegister) * capacity);
+    
+    gc->Registers = newRegs;
+    gc->ArrayCapacity = capacity;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_ShareArray(totemExecState *state, totemGCObject *src, size_t offset, size_t length, totemGCObject **gcOut)
+{
+    if (offset > src->NumRegisters || length > src->NumRegisters - offset)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    // nothing to share, and views must always have registers so the GC reaches their store
+    if (!length)
+    {
+        return totemExecState_CreateArray(state, 0, gcOut);
+    }
+    
+    if (!src->ArrayStore && !TOTEM_GCOBJECT_ISFROZEN(src))
+    {
+        // hand src's registers over to an array nobody else sees, src then views it like any other
+        totemGCObject *store = totemExecState_CreateGCObject(state, totemGCObjectType_Array, 0);
+        if (!store)
+        {
+            return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        }
+        
+        store->Registers = src->Registers;
+        store->NumRegisters = src->NumRegisters;
+        store->ArrayCapacity = src->ArrayCapacity;
+        store->ArrayStore = NULL;
+        
+        src->ArrayCapacity = 0;
+        src->ArrayStore = store;
+        
+        // the store is new, so src may need traversing again to reach it
+        totemExecState_WriteBarrier(state, src);
+    }
+    
+    totemGCObject *view = totemExecState_CreateGCObject(state, totemGCObjectType_Array, 0);
+    if (!view)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    view->Registers = src->Registers + offset;
+    view->NumRegisters = length;
+    view->ArrayCapacity = 0;
+    
+    // frozen arrays never change, so they can be viewed directly
+    view->ArrayStore = TOTEM_GCOBJECT_ISFROZEN(src) ? src : src->ArrayStore;
+    
+    *gcOut = view;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_UnshareArray(totemExecState *state, totemGCObject *gc)
+{
+    if (!gc->ArrayStore)
+    {
+        return totemExecStatus_Continue;
+    }
+    
+    totemRegister *newRegs = totemExecState_Alloc(state, sizeof(totemRegister) * gc->NumRegisters);
+    if (!newRegs)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    totemRegister_InitList(newRegs, gc->NumRegisters);
+    for (size_t i = 0; i < gc->NumRegisters; i++)
+    {
+        totemExecState_Assign(state, &newRegs[i], &gc->Registers[i]);
+    }
+    
+    state->GCNumBytes += (sizeof(totemRegister) * gc->NumRegisters);
+    
+    gc->Registers = newRegs;
+    gc->ArrayCapacity = gc->NumRegisters;
+    gc->ArrayStore = NULL;
+    
+    // values may now only be reachable through this array rather than its old store
+    totemExecState_WriteBarrier(state, gc);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_CreateTypedArray(totemExecState *state, totemTypedArrayType type, totemInt length, totemGCObject **gcOut)
+{
+    size_t elementSize = totemTypedArrayType_GetElementSize(type);
+    if (!elementSize)
+    {
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    if (length < 0 || length >= UINT32_MAX)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    // elements follow the header in the same allocation
+    size_t numBytes = sizeof(totemTypedArray) + (elementSize * (size_t)length);
+    totemTypedArray *arr = totemExecState_Alloc(state, numBytes);
+    if (!arr)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    totemGCObject *gc = totemExecState_CreateGCObject(state, totemGCObjectType_TypedArray, 0);
+    if (!gc)
+    {
+        totemExecState_Free(state, arr, numBytes);
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    arr->Data = arr + 1;
+    arr->Length = (size_t)length;
+    arr->Capacity = (size_t)length;
+    arr->Type = type;
+    arr->Release = NULL;
+    memset(arr->Data, 0, elementSize * (size_t)length);
+    
+    state->GCNumBytes += numBytes;
+    gc->TypedArray = arr;
+    *gcOut = gc;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_CreateExternalTypedArray(totemExecState *state, totemTypedArrayType type, void *data, size_t length, totemUserdataDestructor release, totemGCObject **gcOut)
+{
+    if (!totemTypedArrayType_GetElementSize(type))
+    {
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    if (length >= UINT32_MAX || (!data && length))
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    // only the header is ours, the elements stay where the host put them
+    totemTypedArray *arr = totemExecState_Alloc(state, sizeof(totemTypedArray));
+    if (!arr)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    totemGCObject *gc = totemExecState_CreateGCObject(state, totemGCObjectType_TypedArray, 0);
+    if (!gc)
+    {
+        totemExecState_Free(state, arr, sizeof(totemTypedArray));
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    arr->Data = data;
+    arr->Length = length;
+    arr->Capacity = length;
+    arr->Type = type;
+    arr->Release = release;
+    
+    state->GCNumBytes += sizeof(totemTypedArray);
+    gc->TypedArray = arr;
+    *gcOut = gc;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_ReserveTypedArray(totemExecState *state, totemGCObject *gc, size_t capacity)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(gc))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
+    
+    totemTypedArray *arr = gc->TypedArray;
+    if (capacity <= arr->Capacity)
+    {
+        return totemExecStatus_Continue;
+    }
+    
+    if (TOTEM_TYPEDARRAY_ISEXTERNAL(arr))
+    {
+        return totemExecStatus_Break(totemExecStatus_ExternalValueResized);
+    }
+    
+    if (capacity >= UINT32_MAX)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    size_t elementSize = totemTypedArrayType_GetElementSize(arr->Type);
+    size_t oldNumBytes = sizeof(totemTypedArray) + (elementSize * arr->Capacity);
+    size_t newNumBytes = sizeof(totemTypedArray) + (elementSize * capacity);
+    
+    totemTypedArray *newArr = totemExecState_Alloc(state, newNumBytes);
+    if (!newArr)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    newArr->Data = newArr + 1;
+    newArr->Length = arr->Length;
+    newArr->Capacity = capacity;
+    newArr->Type = arr->Type;
+    newArr->Release = NULL;
+    memcpy(newArr->Data, arr->Data, elementSize * arr->Length);
+    memset(((char*)newArr->Data) + (elementSize * arr->Length), 0, elementSize * (capacity - arr->Length));
+    
+    totemExecState_Free(state, arr, oldNumBytes);
+    state->GCNumBytes -= oldNumBytes;
+    state->GCNumBytes += newNumBytes;
+    
+    gc->TypedArray = newArr;
+    return totemExecStatus_Continue;
+}
+
 totemExecStatus totemExecState_CreateObject(totemExecState *state, totemInt size, totemGCObject **gcOut)
 {
-    totemHashMap *obj = totemExecState_Alloc(state, sizeof(totemHashMap));
+    totemObject *obj = totemExecState_Alloc(state, sizeof(totemObject));
     if (!obj)
     {
         return totemExecStatus_Break(totemExecStatus_OutOfMemory);
     }
     
-    totemHashMap_Init(obj);
+    memset(obj, 0, sizeof(totemObject));
     
-    totemGCObject *gc = totemExecState_CreateGCObject(state, totemGCObjectType_Object, (size_t)size);
+    // room for a key/value pair per literal key
+    totemGCObject *gc = totemExecState_CreateGCObject(state, totemGCObjectType_Object, (size_t)size * 2);
     if (!gc)
     {
-        totem_CacheFree(obj, sizeof(*obj));
+        totemExecState_Free(state, obj, sizeof(*obj));
         return totemExecStatus_Break(totemExecStatus_OutOfMemory);
     }
     
-    state->GCNumBytes += sizeof(totemHashMap);
+    state->GCNumBytes += sizeof(totemObject);
     gc->Object = obj;
     *gcOut = gc;
     return totemExecStatus_Continue;
@@ -934,6 +1254,38 @@ totemExecStatus totemExecState_CreateUserdata(totemExecState *state, void *data,
     return totemExecStatus_Continue;
 }
 
+totemExecStatus totemExecState_CreateRope(totemExecState *state, totemRopeBuffer *buffer, totemInternedStringHeader *source, size_t offset, totemStringLength length, totemGCObject **gcOut)
+{
+    totemRope *rope = totemExecState_Alloc(state, sizeof(totemRope));
+    if (!rope)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    totemGCObject *gc = totemExecState_CreateGCObject(state, totemGCObjectType_Rope, 0);
+    if (!gc)
+    {
+        totemExecState_Free(state, rope, sizeof(totemRope));
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    rope->Buffer = buffer;
+    rope->Source = source;
+    rope->Offset = offset;
+    rope->Length = length;
+    rope->Flattened = NULL;
+    
+    if (buffer)
+    {
+        buffer->NumRopes++;
+    }
+    
+    state->GCNumBytes += sizeof(totemRope);
+    gc->Rope = rope;
+    *gcOut = gc;
+    return totemExecStatus_Continue;
+}
+
 totemExecStatus totemExecState_CreateInstance(totemExecState *state, totemScript *script, totemGCObject **gcOut)
 {
     totemInstance *instance = totemExecState_Alloc(state, sizeof(totemInstance));
@@ -950,14 +1302,14 @@ totemExecStatus totemExecState_CreateInstance(totemExecState *state, totemScript
     size_t numFunctions = totemMemoryBuffer_GetNumObjects(&script->Functions);
     if (!totemMemoryBuffer_Secure(&instance->LocalFunctions, numFunctions))
     {
-        totem_CacheFree(instance, sizeof(totemInstance));
+        totemExecState_Free(state, instance, sizeof(totemInstance));
         return totemExecStatus_Break(totemExecStatus_OutOfMemory);
     }
     
     totemGCObject *gc = totemExecState_CreateGCObject(state, totemGCObjectType_Instance, totemMemoryBuffer_GetNumObjects(&script->GlobalRegisters));
     if (!gc)
     {
-        totem_CacheFree(instance, sizeof(totemInstance));
+        totemExecState_Free(state, instance, sizeof(totemInstance));
         return totemExecStatus_Break(totemExecStatus_OutOfMemory);
     }
     
@@ -988,27 +1340,435 @@ totemExecStatus totemExecState_CreateInstance(totemExecState *state, totemScript
     gc->Instance = instance;
     *gcOut = gc;
     
+    // build constant array & object literals once, NewArray & NewObject copy them from here
+    size_t numTemplates = totemMemoryBuffer_GetNumObjects(&script->Templates);
+    for (size_t i = 0; i < numTemplates; i++)
+    {
+        totemScriptTemplate *scriptTemplate = totemMemoryBuffer_Get(&script->Templates, i);
+        totemOperandXUnsigned *values = totemMemoryBuffer_Get(&script->TemplateValues, scriptTemplate->ValuesStart);
+        totemGCObject *templateGc = NULL;
+        totemExecStatus status = totemExecStatus_Continue;
+        
+        if (scriptTemplate->Type == totemPublicDataType_Array)
+        {
+            status = totemExecState_CreateArray(state, (totemInt)scriptTemplate->NumValues, &templateGc);
+            if (status != totemExecStatus_Continue)
+            {
+                return status;
+            }
+            
+            for (size_t j = 0; j < scriptTemplate->NumValues; j++)
+            {
+                totemExecState_Assign(state, &templateGc->Registers[j], &gc->Registers[values[j]]);
+            }
+            
+            totemExecState_AssignNewArray(state, &gc->Registers[scriptTemplate->Register], templateGc);
+        }
+        else
+        {
+            status = totemExecState_CreateObject(state, (totemInt)(scriptTemplate->NumValues / 2), &templateGc);
+            if (status != totemExecStatus_Continue)
+            {
+                return status;
+            }
+            
+            totemExecState_AssignNewObject(state, &gc->Registers[scriptTemplate->Register], templateGc);
+            
+            for (size_t j = 0; j < scriptTemplate->NumValues; j += 2)
+            {
+                status = totemExecState_ObjectSet(state, templateGc, &gc->Registers[values[j]], &gc->Registers[values[j + 1]]);
+                if (status != totemExecStatus_Continue)
+                {
+                    return status;
+                }
+            }
+        }
+    }
+    
     return totemExecStatus_Continue;
 }
 
+// frozen lock must be held
+static totemGCObject *totemRuntime_CreateFrozenObject(totemRuntime *runtime, totemGCObjectType type, size_t numRegisters)
+{
+    totemGCObject *gc = totemAllocator_Alloc(&runtime->FrozenAllocator, sizeof(totemGCObject));
+    if (!gc)
+    {
+        return NULL;
+    }
+    
+    gc->Type = type;
+    gc->Coroutine = NULL;
+    gc->Registers = NULL;
+    gc->NumRegisters = numRegisters;
+    gc->MarkFlags = totemGCObjectMarkSweepFlag_IsUsed | totemGCObjectMarkSweepFlag_IsFrozen;
+    gc->Header.NextHdr = NULL;
+    gc->Header.PrevHdr = NULL;
+    
+    if (type == totemGCObjectType_Array)
+    {
+        gc->ArrayCapacity = numRegisters;
+        gc->ArrayStore = NULL;
+    }
+    
+    if (numRegisters)
+    {
+        gc->Registers = totemAllocator_Alloc(&runtime->FrozenAllocator, sizeof(totemRegister) * numRegisters);
+        if (!gc->Registers)
+        {
+            totemAllocator_Free(&runtime->FrozenAllocator, gc, sizeof(totemGCObject));
+            return NULL;
+        }
+        
+        totemRegister_InitList(gc->Registers, numRegisters);
+    }
+    
+    if (!totemMemoryBuffer_Insert(&runtime->FrozenObjects, &gc, 1))
+    {
+        totemRuntime_DestroyFrozenObject(runtime, gc);
+        return NULL;
+    }
+    
+    return gc;
+}
+
+// frozen lock must be held, unless the runtime is being cleaned up
+void totemRuntime_DestroyFrozenObject(totemRuntime *runtime, totemGCObject *gc)
+{
+    switch (gc->Type)
+    {
+        case totemGCObjectType_Object:
+            if (gc->Object)
+            {
+                if (gc->Object->Lookup)
+                {
+                    totemHashMap_Cleanup(gc->Object->Lookup);
+                    totemAllocator_Free(&runtime->FrozenAllocator, gc->Object->Lookup, sizeof(totemHashMap));
+                }
+                
+                totemAllocator_Free(&runtime->FrozenAllocator, gc->Object, sizeof(totemObject));
+            }
+            break;
+            
+        case totemGCObjectType_TypedArray:
+            if (gc->TypedArray)
+            {
+                size_t numBytes = sizeof(totemTypedArray) + (totemTypedArrayType_GetElementSize(gc->TypedArray->Type) * gc->TypedArray->Capacity);
+                totemAllocator_Free(&runtime->FrozenAllocator, gc->TypedArray, numBytes);
+            }
+            break;
+            
+        default:
+            break;
+    }
+    
+    if (gc->Registers)
+    {
+        totemAllocator_Free(&runtime->FrozenAllocator, gc->Registers, sizeof(totemRegister) * gc->NumRegisters);
+    }
+    
+    totemAllocator_Free(&runtime->FrozenAllocator, gc, sizeof(totemGCObject));
+}
+
+static totemExecStatus totemExecState_FreezeRegister(totemExecState *state, totemHashMap *copies, totemRegister *src, totemRegister *dst);
+
+static totemExecStatus totemExecState_FreezeGCObject(totemExecState *state, totemHashMap *copies, totemGCObject *src, totemGCObject **gcOut)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(src))
+    {
+        *gcOut = src;
+        return totemExecStatus_Continue;
+    }
+    
+    totemHashMapEntry *entry = totemHashMap_Find(copies, &src, sizeof(src));
+    if (entry)
+    {
+        *gcOut = (totemGCObject*)entry->Value;
+        return totemExecStatus_Continue;
+    }
+    
+    totemRuntime *runtime = state->Runtime;
+    totemGCObject *gc = NULL;
+    
+    switch (src->Type)
+    {
+        case totemGCObjectType_Array:
+            gc = totemRuntime_CreateFrozenObject(runtime, totemGCObjectType_Array, src->NumRegisters);
+            if (!gc)
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+            break;
+            
+        case totemGCObjectType_Object:
+            gc = totemRuntime_CreateFrozenObject(runtime, totemGCObjectType_Object, src->Object->NumKeys * 2);
+            if (!gc)
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+            
+            gc->Object = totemAllocator_Alloc(&runtime->FrozenAllocator, sizeof(totemObject));
+            if (!gc->Object)
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+            
+            memset(gc->Object, 0, sizeof(totemObject));
+            break;
+            
+        case totemGCObjectType_TypedArray:
+        {
+            gc = totemRuntime_CreateFrozenObject(runtime, totemGCObjectType_TypedArray, 0);
+            if (!gc)
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+            
+            totemTypedArray *srcArr = src->TypedArray;
+            size_t numDataBytes = totemTypedArrayType_GetElementSize(srcArr->Type) * srcArr->Length;
+            
+            totemTypedArray *arr = totemAllocator_Alloc(&runtime->FrozenAllocator, sizeof(totemTypedArray) + numDataBytes);
+            if (!arr)
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+            
+            arr->Data = arr + 1;
+            arr->Length = srcArr->Length;
+            arr->Capacity = srcArr->Length;
+            arr->Type = srcArr->Type;
+            arr->Release = NULL;
+            memcpy(arr->Data, srcArr->Data, numDataBytes);
+            gc->TypedArray = arr;
+            break;
+        }
+            
+        default:
+            return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    // recorded before copying any values, so cycles lead back to this copy
+    if (!totemHashMap_Insert(copies, &src, sizeof(src), (totemHashValue)(uintptr_t)gc))
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    totemExecStatus status = totemExecStatus_Continue;
+    
+    if (src->Type == totemGCObjectType_Array)
+    {
+        for (size_t i = 0; i < src->NumRegisters && status == totemExecStatus_Continue; i++)
+        {
+            status = totemExecState_FreezeRegister(state, copies, &src->Registers[i], &gc->Registers[i]);
+        }
+    }
+    else if (src->Type == totemGCObjectType_Object)
+    {
+        // close up any gaps left by removed keys, nothing will be added to fill them
+        size_t numPairs = 0;
+        for (size_t i = 0; i < src->Object->NumPairs && status == totemExecStatus_Continue; i++)
+        {
+            totemRegister *key = TOTEM_OBJECT_KEY(src, i);
+            if (totemRegister_IsNull(key))
+            {
+                continue;
+            }
+            
+            status = totemExecState_FreezeRegister(state, copies, key, TOTEM_OBJECT_KEY(gc, numPairs));
+            if (status == totemExecStatus_Continue)
+            {
+                status = totemExecState_FreezeRegister(state, copies, TOTEM_OBJECT_VALUE(src, i), TOTEM_OBJECT_VALUE(gc, numPairs));
+            }
+            
+            numPairs++;
+        }
+        
+        gc->Object->NumPairs = numPairs;
+        gc->Object->NumKeys = numPairs;
+        
+        if (status == totemExecStatus_Continue && numPairs > TOTEM_EXEC_SMALLOBJECTKEYS)
+        {
+            totemHashMap *lookup = totemAllocator_Alloc(&runtime->FrozenAllocator, sizeof(totemHashMap));
+            if (!lookup)
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+            
+            totemHashMap_Init(lookup);
+            lookup->Allocator = &runtime->FrozenAllocator;
+            gc->Object->Lookup = lookup;
+            
+            if (!totemObject_BuildLookup(gc, lookup))
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+        }
+    }
+    
+    *gcOut = gc;
+    return status;
+}
+
+static totemExecStatus totemExecState_FreezeRegister(totemExecState *state, totemHashMap *copies, totemRegister *src, totemRegister *dst)
+{
+    totemGCObject *gc = NULL;
+    totemExecStatus status = totemExecStatus_Continue;
+    
+    switch (totemRegister_GetType(src))
+    {
+        case totemPrivateDataType_InstanceFunction:
+        case totemPrivateDataType_Coroutine:
+        case totemPrivateDataType_Userdata:
+            return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+            
+        case totemPrivateDataType_InternedString:
+        case totemPrivateDataType_Rope:
+            status = totemExecState_FlattenString(state, src, dst);
+            if (status == totemExecStatus_Continue && totemRegister_IsInternedString(dst))
+            {
+                // frozen values outlive any exec state that might otherwise be keeping their strings alive
+                totemInternedStringHeader_Mark(totemRegister_GetInternedString(dst), TOTEM_INTERNEDSTRING_PINNED);
+            }
+            return status;
+            
+        case totemPrivateDataType_Array:
+            status = totemExecState_FreezeGCObject(state, copies, totemRegister_GetGCObject(src), &gc);
+            if (status == totemExecStatus_Continue)
+            {
+                totemExecState_AssignNewArray(state, dst, gc);
+            }
+            return status;
+            
+        case totemPrivateDataType_TypedArray:
+            status = totemExecState_FreezeGCObject(state, copies, totemRegister_GetGCObject(src), &gc);
+            if (status == totemExecStatus_Continue)
+            {
+                totemExecState_AssignNewTypedArray(state, dst, gc);
+            }
+            return status;
+            
+        case totemPrivateDataType_Object:
+            status = totemExecState_FreezeGCObject(state, copies, totemRegister_GetGCObject(src), &gc);
+            if (status == totemExecStatus_Continue)
+            {
+                totemExecState_AssignNewObject(state, dst, gc);
+            }
+            return status;
+            
+        default:
+            memcpy(dst, src, sizeof(totemRegister));
+            return totemExecStatus_Continue;
+    }
+}
+
+totemExecStatus totemExecState_Freeze(totemExecState *state, totemRegister *src, totemRegister *dst)
+{
+    totemRuntime *runtime = state->Runtime;
+    
+    totemHashMap copies;
+    totemHashMap_Init(&copies);
+    copies.Allocator = &state->Allocator;
+    
+    totemRegister frozen;
+    totemRegister_SetNull(&frozen);
+    
+    totemLock_Acquire(&runtime->FrozenLock);
+    
+    size_t numBefore = totemMemoryBuffer_GetNumObjects(&runtime->FrozenObjects);
+    totemExecStatus status = totemExecState_FreezeRegister(state, &copies, src, &frozen);
+    
+    if (status != totemExecStatus_Continue)
+    {
+        // nothing else has seen the partial copy yet, so it can go straight away
+        size_t numAfter = totemMemoryBuffer_GetNumObjects(&runtime->FrozenObjects);
+        for (size_t i = numBefore; i < numAfter; i++)
+        {
+            totemGCObject **gc = totemMemoryBuffer_Get(&runtime->FrozenObjects, i);
+            totemRuntime_DestroyFrozenObject(runtime, *gc);
+        }
+        
+        totemMemoryBuffer_Pop(&runtime->FrozenObjects, numAfter - numBefore);
+    }
+    
+    totemLock_Release(&runtime->FrozenLock);
+    totemHashMap_Cleanup(&copies);
+    
+    if (status == totemExecStatus_Continue)
+    {
+        totemExecState_Assign(state, dst, &frozen);
+    }
+    
+    return status;
+}
+
 void totemExecState_DestroyCoroutine(totemExecState *state, totemFunctionCall *co)
 {
     state->GCNumBytes -= sizeof(totemFunctionCall);
     totemExecState_FreeFunctionCall(state, co);
 }
 
-void totemExecState_DestroyObject(totemExecState *state, totemHashMap *obj)
+void totemExecState_DestroyObject(totemExecState *state, totemObject *obj)
 {
-    state->GCNumBytes -= sizeof(totemHashMap) + (sizeof(totemRegister) * obj->NumKeys) + (sizeof(totemHashMapEntry) * obj->NumKeys);
-    totemHashMap_Cleanup(obj);
-    totem_CacheFree(obj, sizeof(totemHashMap));
+    if (obj->Lookup)
+    {
+        state->GCNumBytes -= sizeof(totemHashMap) + (sizeof(totemHashMapEntry) * obj->Lookup->NumKeys);
+        totemHashMap_Cleanup(obj->Lookup);
+        totemExecState_Free(state, obj->Lookup, sizeof(totemHashMap));
+    }
+    
+    state->GCNumBytes -= sizeof(totemObject);
+    totemExecState_Free(state, obj, sizeof(totemObject));
 }
 
 void totemExecState_DestroyInstance(totemExecState *state, totemInstance *obj)
 {
     state->GCNumBytes -= sizeof(totemInstance) + obj->LocalFunctions.MaxLength;
     totemInstance_Cleanup(obj);
-    totem_CacheFree(obj, sizeof(totemInstance));
+    totemExecState_Free(state, obj, sizeof(totemInstance));
+}
+
+void totemExecState_DestroyRope(totemExecState *state, totemRope *rope)
+{
+    totemRopeBuffer *buffer = rope->Buffer;
+    
+    if (buffer && --buffer->NumRopes == 0)
+    {
+        state->GCNumBytes -= sizeof(totemRopeBuffer) + buffer->Capacity;
+        totemExecState_Free(state, buffer->Data, buffer->Capacity);
+        totemExecState_Free(state, buffer, sizeof(totemRopeBuffer));
+    }
+    
+    state->GCNumBytes -= sizeof(totemRope);
+    totemExecState_Free(state, rope, sizeof(totemRope));
+}
+
+void totemExecState_DestroyTypedArray(totemExecState *state, totemTypedArray *arr)
+{
+    if (TOTEM_TYPEDARRAY_ISEXTERNAL(arr))
+    {
+        if (arr->Release)
+        {
+            arr->Release(state, arr->Data);
+        }
+        
+        state->GCNumBytes -= sizeof(totemTypedArray);
+        totemExecState_Free(state, arr, sizeof(totemTypedArray));
+        return;
+    }
+    
+    size_t numBytes = sizeof(totemTypedArray) + (totemTypedArrayType_GetElementSize(arr->Type) * arr->Capacity);
+    state->GCNumBytes -= numBytes;
+    totemExecState_Free(state, arr, numBytes);
+}
+
+const char *totemRope_GetData(totemRope *rope)
+{
+    if (rope->Buffer)
+    {
+        return rope->Buffer->Data + rope->Offset;
+    }
+    
+    return rope->Source->Data + rope->Offset;
 }
 
 const char *totemGCObjectType_Describe(totemGCObjectType type)
@@ -1020,7 +1780,42 @@ const char *totemGCObjectType_Describe(totemGCObjectType type)
             TOTEM_STRINGIFY_CASE(totemGCObjectType_Object);
             TOTEM_STRINGIFY_CASE(totemGCObjectType_Userdata);
             TOTEM_STRINGIFY_CASE(totemGCObjectType_Instance);
+            TOTEM_STRINGIFY_CASE(totemGCObjectType_Rope);
+            TOTEM_STRINGIFY_CASE(totemGCObjectType_TypedArray);
             TOTEM_STRINGIFY_CASE(totemGCObjectType_Deleting);
         default:return "UNKNOWN";
     }
 }
+
+const char *totemTypedArrayType_Describe(totemTypedArrayType type)
+{
+    switch (type)
+    {
+            TOTEM_STRINGIFY_CASE(totemTypedArrayType_Float64);
+            TOTEM_STRINGIFY_CASE(totemTypedArrayType_Int32);
+            TOTEM_STRINGIFY_CASE(totemTypedArrayType_Int64);
+            TOTEM_STRINGIFY_CASE(totemTypedArrayType_Uint8);
+        default:return "UNKNOWN";
+    }
+}
+
+size_t totemTypedArrayType_GetElementSize(totemTypedArrayType type)
+{
+    switch (type)
+    {
+        case totemTypedArrayType_Float64:
+            return sizeof(double);
+            
+        case totemTypedArrayType_Int32:
+            return sizeof(int32_t);
+            
+        case totemTypedArrayType_Int64:
+            return sizeof(int64_t);
+            
+        case totemTypedArrayType_Uint8:
+            return sizeof(uint8_t);
+            
+        default:
+            return 0;
+    }
+}
@@ -96,9 +96,994 @@ totemExecStatus totemSqrt(totemExecState *state)
     return totemExecStatus_Continue;
 }
 
+totemExecStatus totemSubstring(totemExecState *state)
+{
+    if (state->CallStack->NumArguments < 2)
+    {
+        printf("no arguments substring\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *strReg = &state->LocalRegisters[0];
+    totemRegister *startReg = &state->LocalRegisters[1];
+    totemRegister *lengthReg = &state->LocalRegisters[2];
+    
+    if (!totemRegister_IsString(strReg) || !totemRegister_IsInt(startReg))
+    {
+        printf("expected string & int substring\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemInt start = totemRegister_GetInt(startReg);
+    totemInt length = (totemInt)totemRegister_GetStringLength(strReg) - start;
+    
+    if (state->CallStack->NumArguments > 2)
+    {
+        if (!totemRegister_IsInt(lengthReg))
+        {
+            printf("expected int length substring\n");
+            return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+        }
+        
+        length = totemRegister_GetInt(lengthReg);
+    }
+    
+    return totemExecState_SliceString(state, strReg, start, length, state->CallStack->ReturnRegister);
+}
+
+totemExecStatus totemByte(totemExecState *state)
+{
+    if (state->CallStack->NumArguments < 2)
+    {
+        printf("no arguments byte\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *strReg = &state->LocalRegisters[0];
+    totemRegister *indexReg = &state->LocalRegisters[1];
+    
+    if (!totemRegister_IsString(strReg) || !totemRegister_IsInt(indexReg))
+    {
+        printf("expected string & int byte\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    return totemExecState_StringByte(state, strReg, totemRegister_GetInt(indexReg), state->CallStack->ReturnRegister);
+}
+
+// float64array(n) etc. - either a length, an array (typed or not) whose elements are converted, or a string whose bytes are
+static totemExecStatus totemTypedArray_New(totemExecState *state, totemTypedArrayType type, const char *name)
+{
+    if (!state->CallStack->NumArguments)
+    {
+        printf("no arguments %s\n", name);
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *arg = &state->LocalRegisters[0];
+    totemGCObject *gc = NULL;
+    
+    if (totemRegister_IsInt(arg))
+    {
+        totemExecStatus status = totemExecState_CreateTypedArray(state, type, totemRegister_GetInt(arg), &gc);
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+    }
+    else if (totemRegister_IsArray(arg) || totemRegister_IsTypedArray(arg))
+    {
+        totemGCObject *src = totemRegister_GetGCObject(arg);
+        size_t length = totemRegister_IsArray(arg) ? src->NumRegisters : src->TypedArray->Length;
+        
+        totemExecStatus status = totemExecState_CreateTypedArray(state, type, (totemInt)length, &gc);
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+        
+        for (size_t i = 0; i < length && status == totemExecStatus_Continue; i++)
+        {
+            if (totemRegister_IsArray(arg))
+            {
+                status = totemExecState_TypedArraySet(state, gc->TypedArray, (totemInt)i, &src->Registers[i]);
+            }
+            else
+            {
+                totemRegister val;
+                totemRegister_SetNull(&val);
+                status = totemExecState_TypedArrayGet(state, src->TypedArray, (totemInt)i, &val);
+                if (status == totemExecStatus_Continue)
+                {
+                    status = totemExecState_TypedArraySet(state, gc->TypedArray, (totemInt)i, &val);
+                }
+            }
+        }
+        
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+    }
+    else if (totemRegister_IsString(arg))
+    {
+        totemStringLength length = totemRegister_GetStringLength(arg);
+        
+        totemExecStatus status = totemExecState_CreateTypedArray(state, type, (totemInt)length, &gc);
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+        
+        totemRuntimeStringValue val;
+        totemRegister_GetStringValue(arg, &val);
+        
+        for (size_t i = 0; i < length && status == totemExecStatus_Continue; i++)
+        {
+            totemRegister byte;
+            totemRegister_SetInt(&byte, (uint8_t)val.Value[i]);
+            status = totemExecState_TypedArraySet(state, gc->TypedArray, (totemInt)i, &byte);
+        }
+        
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+    }
+    else
+    {
+        printf("expected int, array or string %s\n", name);
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemExecState_AssignNewTypedArray(state, state->CallStack->ReturnRegister, gc);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemFloat64Array(totemExecState *state)
+{
+    return totemTypedArray_New(state, totemTypedArrayType_Float64, "float64array");
+}
+
+totemExecStatus totemInt32Array(totemExecState *state)
+{
+    return totemTypedArray_New(state, totemTypedArrayType_Int32, "int32array");
+}
+
+totemExecStatus totemInt64Array(totemExecState *state)
+{
+    return totemTypedArray_New(state, totemTypedArrayType_Int64, "int64array");
+}
+
+totemExecStatus totemUint8Array(totemExecState *state)
+{
+    return totemTypedArray_New(state, totemTypedArrayType_Uint8, "uint8array");
+}
+
+totemExecStatus totemPush(totemExecState *state)
+{
+    if (state->CallStack->NumArguments < 2)
+    {
+        printf("no arguments push\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *arrReg = &state->LocalRegisters[0];
+    
+    if (totemRegister_IsTypedArray(arrReg))
+    {
+        totemGCObject *gc = totemRegister_GetGCObject(arrReg);
+        
+        for (size_t i = 1; i < state->CallStack->NumArguments; i++)
+        {
+            totemExecStatus status = totemExecState_TypedArrayPush(state, gc, &state->LocalRegisters[i]);
+            if (status != totemExecStatus_Continue)
+            {
+                return status;
+            }
+        }
+        
+        totemExecState_AssignNewInt(state, state->CallStack->ReturnRegister, (totemInt)gc->TypedArray->Length);
+        return totemExecStatus_Continue;
+    }
+    
+    if (!totemRegister_IsArray(arrReg))
+    {
+        printf("expected array push\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemGCObject *gc = totemRegister_GetGCObject(arrReg);
+    
+    // push(arr, a, b, c) appends all three
+    for (size_t i = 1; i < state->CallStack->NumArguments; i++)
+    {
+        totemExecStatus status = totemExecState_ArrayPush(state, gc, &state->LocalRegisters[i]);
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+    }
+    
+    totemExecState_WriteBarrier(state, gc);
+    totemExecState_AssignNewInt(state, state->CallStack->ReturnRegister, (totemInt)gc->NumRegisters);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemPop(totemExecState *state)
+{
+    if (!state->CallStack->NumArguments)
+    {
+        printf("no arguments pop\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *arrReg = &state->LocalRegisters[0];
+    
+    if (totemRegister_IsTypedArray(arrReg))
+    {
+        return totemExecState_TypedArrayPop(state, totemRegister_GetGCObject(arrReg), state->CallStack->ReturnRegister);
+    }
+    
+    if (!totemRegister_IsArray(arrReg))
+    {
+        printf("expected array pop\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    return totemExecState_ArrayPop(state, totemRegister_GetGCObject(arrReg), state->CallStack->ReturnRegister);
+}
+
+totemExecStatus totemReserve(totemExecState *state)
+{
+    if (state->CallStack->NumArguments < 2)
+    {
+        printf("no arguments reserve\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *arrReg = &state->LocalRegisters[0];
+    totemRegister *capacityReg = &state->LocalRegisters[1];
+    
+    if (!(totemRegister_IsArray(arrReg) || totemRegister_IsTypedArray(arrReg)) || !totemRegister_IsInt(capacityReg))
+    {
+        printf("expected array & int reserve\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemInt capacity = totemRegister_GetInt(capacityReg);
+    if (capacity < 0)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    if (totemRegister_IsTypedArray(arrReg))
+    {
+        return totemExecState_ReserveTypedArray(state, totemRegister_GetGCObject(arrReg), (size_t)capacity);
+    }
+    
+    return totemExecState_ReserveArray(state, totemRegister_GetGCObject(arrReg), (size_t)capacity);
+}
+
+// slice(arr, start, length) - shares arr's values until either is written to, typed arrays are copied
+totemExecStatus totemSlice(totemExecState *state)
+{
+    if (state->CallStack->NumArguments < 2)
+    {
+        printf("no arguments slice\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *arrReg = &state->LocalRegisters[0];
+    totemRegister *startReg = &state->LocalRegisters[1];
+    totemRegister *lengthReg = &state->LocalRegisters[2];
+    
+    if (!(totemRegister_IsArray(arrReg) || totemRegister_IsTypedArray(arrReg)) || !totemRegister_IsInt(startReg))
+    {
+        printf("expected array & int slice\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemGCObject *src = totemRegister_GetGCObject(arrReg);
+    totemInt start = totemRegister_GetInt(startReg);
+    totemInt length = (totemInt)(totemRegister_IsTypedArray(arrReg) ? src->TypedArray->Length : src->NumRegisters) - start;
+    
+    if (state->CallStack->NumArguments > 2)
+    {
+        if (!totemRegister_IsInt(lengthReg))
+        {
+            printf("expected int length slice\n");
+            return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+        }
+        
+        length = totemRegister_GetInt(lengthReg);
+    }
+    
+    if (start < 0 || length < 0)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    totemGCObject *gc = NULL;
+    
+    if (totemRegister_IsTypedArray(arrReg))
+    {
+        totemExecStatus status = totemExecState_SliceTypedArray(state, src->TypedArray, (size_t)start, (size_t)length, &gc);
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+        
+        totemExecState_AssignNewTypedArray(state, state->CallStack->ReturnRegister, gc);
+        return totemExecStatus_Continue;
+    }
+    
+    totemExecStatus status = totemExecState_ShareArray(state, src, (size_t)start, (size_t)length, &gc);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    totemExecState_AssignNewArray(state, state->CallStack->ReturnRegister, gc);
+    return totemExecStatus_Continue;
+}
+
+// freeze(value) - a deep, read-only copy of value that any exec state sharing the runtime can read
+totemExecStatus totemFreeze(totemExecState *state)
+{
+    if (!state->CallStack->NumArguments)
+    {
+        printf("no arguments freeze\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    return totemExecState_Freeze(state, &state->LocalRegisters[0], state->CallStack->ReturnRegister);
+}
+
+typedef struct
+{
+    totemExecState *State;
+    totemRegister *Comparator;
+    totemExecStatus Status;
+}
+totemSortContext;
+
+/*
+ * Pattern-defeating quicksort, instantiated once per element type so comparisons can be inlined
+ * Elements only ever move by swapping, so a comparator that runs script code always sees every value still in the array,
+ * & every loop is bounds-checked so an inconsistent comparator can't run off either end
+ */
+#define TOTEM_SORT_INSERTIONTHRESHOLD (24)
+#define TOTEM_SORT_NINTHERTHRESHOLD (128)
+#define TOTEM_SORT_PARTIALINSERTIONLIMIT (8)
+
+#define TOTEM_SORT_DEFINE(name, type, less) \
+    static void name##_Swap(type *a, type *b) \
+    { \
+        type tmp = *a; \
+        *a = *b; \
+        *b = tmp; \
+    } \
+    \
+    static void name##_Sort3(totemSortContext *ctx, type *a, type *b, type *c) \
+    { \
+        if (less(ctx, b, a)) { name##_Swap(a, b); } \
+        if (less(ctx, c, b)) { name##_Swap(b, c); } \
+        if (less(ctx, b, a)) { name##_Swap(a, b); } \
+    } \
+    \
+    static void name##_InsertionSort(totemSortContext *ctx, type *v, size_t n) \
+    { \
+        for (size_t i = 1; i < n; i++) \
+        { \
+            for (size_t j = i; j > 0 && less(ctx, &v[j], &v[j - 1]); j--) \
+            { \
+                name##_Swap(&v[j], &v[j - 1]); \
+            } \
+        } \
+    } \
+    \
+    /* gives up once too many elements are out of place, returning whether v is now sorted */ \
+    static totemBool name##_PartialInsertionSort(totemSortContext *ctx, type *v, size_t n) \
+    { \
+        size_t moves = 0; \
+        for (size_t i = 1; i < n; i++) \
+        { \
+            for (size_t j = i; j > 0 && less(ctx, &v[j], &v[j - 1]); j--) \
+            { \
+                name##_Swap(&v[j], &v[j - 1]); \
+                if (++moves > TOTEM_SORT_PARTIALINSERTIONLIMIT) \
+                { \
+                    return totemBool_False; \
+                } \
+            } \
+        } \
+        return totemBool_True; \
+    } \
+    \
+    static void name##_HeapSort(totemSortContext *ctx, type *v, size_t n) \
+    { \
+        for (size_t start = n / 2; start-- > 0;) \
+        { \
+            for (size_t root = start, child; (child = (root * 2) + 1) < n; root = child) \
+            { \
+                if (child + 1 < n && less(ctx, &v[child], &v[child + 1])) { child++; } \
+                if (!less(ctx, &v[root], &v[child])) { break; } \
+                name##_Swap(&v[root], &v[child]); \
+            } \
+        } \
+        for (size_t end = n; end-- > 1;) \
+        { \
+            name##_Swap(&v[0], &v[end]); \
+            for (size_t root = 0, child; (child = (root * 2) + 1) < end; root = child) \
+            { \
+                if (child + 1 < end && less(ctx, &v[child], &v[child + 1])) { child++; } \
+                if (!less(ctx, &v[root], &v[child])) { break; } \
+                name##_Swap(&v[root], &v[child]); \
+            } \
+        } \
+    } \
+    \
+    /* pivot is v[0], elements less than it go left - returns where the pivot ends up */ \
+    static size_t name##_PartitionRight(totemSortContext *ctx, type *v, size_t n, totemBool *alreadyPartitioned) \
+    { \
+        size_t i = 1, j = n - 1; \
+        while (i <= j && less(ctx, &v[i], &v[0])) { i++; } \
+        while (j >= i && !less(ctx, &v[j], &v[0])) { j--; } \
+        *alreadyPartitioned = i > j; \
+        while (i < j) \
+        { \
+            name##_Swap(&v[i++], &v[j--]); \
+            while (i <= j && less(ctx, &v[i], &v[0])) { i++; } \
+            while (j >= i && !less(ctx, &v[j], &v[0])) { j--; } \
+        } \
+        name##_Swap(&v[0], &v[i - 1]); \
+        return i - 1; \
+    } \
+    \
+    /* pivot is v[0], elements equal to it go left - used when it's equal to the pivot before v, so they're already in place */ \
+    static size_t name##_PartitionLeft(totemSortContext *ctx, type *v, size_t n) \
+    { \
+        size_t i = 1, j = n - 1; \
+        while (j >= i && less(ctx, &v[0], &v[j])) { j--; } \
+        while (i <= j && !less(ctx, &v[0], &v[i])) { i++; } \
+        while (i < j) \
+        { \
+            name##_Swap(&v[i++], &v[j--]); \
+            while (j >= i && less(ctx, &v[0], &v[j])) { j--; } \
+            while (i <= j && !less(ctx, &v[0], &v[i])) { i++; } \
+        } \
+        name##_Swap(&v[0], &v[j]); \
+        return j; \
+    } \
+    \
+    static void name##_Loop(totemSortContext *ctx, type *v, size_t n, size_t badAllowed, totemBool leftmost) \
+    { \
+        while (n > 1) \
+        { \
+            if (n < TOTEM_SORT_INSERTIONTHRESHOLD) \
+            { \
+                name##_InsertionSort(ctx, v, n); \
+                return; \
+            } \
+            \
+            size_t mid = n / 2; \
+            if (n > TOTEM_SORT_NINTHERTHRESHOLD) \
+            { \
+                name##_Sort3(ctx, &v[0], &v[mid], &v[n - 1]); \
+                name##_Sort3(ctx, &v[1], &v[mid - 1], &v[n - 2]); \
+                name##_Sort3(ctx, &v[2], &v[mid + 1], &v[n - 3]); \
+                name##_Sort3(ctx, &v[mid - 1], &v[mid], &v[mid + 1]); \
+                name##_Swap(&v[0], &v[mid]); \
+            } \
+            else \
+            { \
+                name##_Sort3(ctx, &v[mid], &v[0], &v[n - 1]); \
+            } \
+            \
+            if (!leftmost && !less(ctx, &v[-1], &v[0])) \
+            { \
+                size_t pivot = name##_PartitionLeft(ctx, v, n); \
+                v += pivot + 1; \
+                n -= pivot + 1; \
+                continue; \
+            } \
+            \
+            totemBool alreadyPartitioned = totemBool_False; \
+            size_t pivot = name##_PartitionRight(ctx, v, n, &alreadyPartitioned); \
+            size_t left = pivot, right = n - pivot - 1; \
+            \
+            if (left < n / 8 || right < n / 8) \
+            { \
+                /* too unbalanced - fall back to heapsort if it keeps happening, otherwise break up whatever pattern caused it */ \
+                if (--badAllowed == 0) \
+                { \
+                    name##_HeapSort(ctx, v, n); \
+                    return; \
+                } \
+                if (left >= TOTEM_SORT_INSERTIONTHRESHOLD) \
+                { \
+                    name##_Swap(&v[0], &v[left / 4]); \
+                    name##_Swap(&v[pivot - 1], &v[pivot - (left / 4)]); \
+                } \
+                if (right >= TOTEM_SORT_INSERTIONTHRESHOLD) \
+                { \
+                    name##_Swap(&v[pivot + 1], &v[pivot + 1 + (right / 4)]); \
+                    name##_Swap(&v[n - 1], &v[n - (right / 4)]); \
+                } \
+            } \
+            else if (alreadyPartitioned && name##_PartialInsertionSort(ctx, v, left) && name##_PartialInsertionSort(ctx, &v[pivot + 1], right)) \
+            { \
+                return; \
+            } \
+            \
+            name##_Loop(ctx, v, left, badAllowed, leftmost); \
+            v += pivot + 1; \
+            n = right; \
+            leftmost = totemBool_False; \
+        } \
+    } \
+    \
+    static void name(totemSortContext *ctx, type *v, size_t n) \
+    { \
+        size_t badAllowed = 1; \
+        for (size_t i = n; i > 1; i >>= 1) { badAllowed++; } \
+        name##_Loop(ctx, v, n, badAllowed, totemBool_True); \
+    }
+
+#define TOTEM_SORT_FLOATLESS(ctx, a, b) (*(a) < *(b))
+
+// large ints don't survive conversion to double, so a tie after converting is settled between the ints themselves
+static inline TOTEM_INLINE int totemSort_CompareIntFloat(totemInt i, totemFloat f)
+{
+    totemFloat d = (totemFloat)i;
+    if (d != f)
+    {
+        // nan compares as neither less nor greater
+        return (d > f) - (d < f);
+    }
+    
+    // f is whole here - the only value it can take beyond totemInt's range is the one just past the top
+    if (f >= -(totemFloat)TOTEM_MINVAL_SIGNED(totemInt, TOTEM_NUMBITS(totemInt)))
+    {
+        return -1;
+    }
+    
+    totemInt fi = (totemInt)f;
+    return (i > fi) - (i < fi);
+}
+
+static inline TOTEM_INLINE totemBool totemSort_NumberLess(totemSortContext *ctx, totemRegister *a, totemRegister *b)
+{
+    totemBool aInt = totemRegister_IsInt(a);
+    totemBool bInt = totemRegister_IsInt(b);
+    
+    if (aInt && bInt)
+    {
+        return totemRegister_GetInt(a) < totemRegister_GetInt(b);
+    }
+    
+    if (aInt)
+    {
+        return totemSort_CompareIntFloat(totemRegister_GetInt(a), totemRegister_GetFloat(b)) < 0;
+    }
+    
+    if (bInt)
+    {
+        return totemSort_CompareIntFloat(totemRegister_GetInt(b), totemRegister_GetFloat(a)) > 0;
+    }
+    
+    return totemRegister_GetFloat(a) < totemRegister_GetFloat(b);
+}
+
+static inline TOTEM_INLINE totemBool totemSort_StringLess(totemSortContext *ctx, totemRegister *a, totemRegister *b)
+{
+    totemRuntimeStringValue aVal, bVal;
+    totemRegister_GetStringValue(a, &aVal);
+    totemRegister_GetStringValue(b, &bVal);
+    
+    totemStringLength aLen = totemRegister_GetStringLength(a);
+    totemStringLength bLen = totemRegister_GetStringLength(b);
+    
+    int cmp = memcmp(aVal.Value, bVal.Value, aLen < bLen ? aLen : bLen);
+    return cmp < 0 || (cmp == 0 && aLen < bLen);
+}
+
+// once the comparator fails, every comparison is false so the sort winds down quickly
+static totemBool totemSort_ComparatorLess(totemSortContext *ctx, totemRegister *a, totemRegister *b)
+{
+    if (ctx->Status != totemExecStatus_Continue)
+    {
+        return totemBool_False;
+    }
+    
+    totemRegister args[2] = { *a, *b };
+    totemRegister result;
+    totemRegister_InitList(&result, 1);
+    
+    ctx->Status = totemExecState_Call(ctx->State, ctx->Comparator, args, 2, &result);
+    totemBool isLess = ctx->Status == totemExecStatus_Continue && totemRegister_IsNotZero(&result);
+    totemExecState_AssignNull(ctx->State, &result);
+    return isLess;
+}
+
+TOTEM_SORT_DEFINE(totemSort_Floats, totemFloat, TOTEM_SORT_FLOATLESS)
+TOTEM_SORT_DEFINE(totemSort_Numbers, totemRegister, totemSort_NumberLess)
+TOTEM_SORT_DEFINE(totemSort_Strings, totemRegister, totemSort_StringLess)
+TOTEM_SORT_DEFINE(totemSort_Comparator, totemRegister, totemSort_ComparatorLess)
+
+// least-significant byte first, skipping any byte every key shares - keys are biased so they sort unsigned
+#define TOTEM_SORT_INTBIAS (((uint64_t)1) << 63)
+
+static totemExecStatus totemSort_Radix(totemExecState *state, uint64_t *keys, size_t n)
+{
+    uint64_t *scratch = totemExecState_Alloc(state, sizeof(uint64_t) * n);
+    if (!scratch)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    size_t counts[sizeof(uint64_t)][256];
+    memset(counts, 0, sizeof(counts));
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        for (size_t byte = 0; byte < sizeof(uint64_t); byte++)
+        {
+            counts[byte][(keys[i] >> (byte * 8)) & 0xFF]++;
+        }
+    }
+    
+    uint64_t *src = keys, *dst = scratch;
+    for (size_t byte = 0; byte < sizeof(uint64_t); byte++)
+    {
+        size_t *count = counts[byte];
+        if (count[(keys[0] >> (byte * 8)) & 0xFF] == n)
+        {
+            continue;
+        }
+        
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < 256; bucket++)
+        {
+            size_t num = count[bucket];
+            count[bucket] = offset;
+            offset += num;
+        }
+        
+        for (size_t i = 0; i < n; i++)
+        {
+            dst[count[(src[i] >> (byte * 8)) & 0xFF]++] = src[i];
+        }
+        
+        uint64_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+    
+    if (src != keys)
+    {
+        memcpy(keys, src, sizeof(uint64_t) * n);
+    }
+    
+    totemExecState_Free(state, scratch, sizeof(uint64_t) * n);
+    return totemExecStatus_Continue;
+}
+
+static totemExecStatus totemSort_TypedArray(totemExecState *state, totemTypedArray *arr)
+{
+    size_t n = arr->Length;
+    
+    if (n < 2)
+    {
+        return totemExecStatus_Continue;
+    }
+    
+    if (arr->Type == totemTypedArrayType_Float64)
+    {
+        totemSort_Floats(NULL, (totemFloat*)arr->Data, n);
+        return totemExecStatus_Continue;
+    }
+    
+    uint64_t *keys = totemExecState_Alloc(state, sizeof(uint64_t) * n);
+    if (!keys)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        int64_t val = 0;
+        switch (arr->Type)
+        {
+            case totemTypedArrayType_Int32:
+                val = ((int32_t*)arr->Data)[i];
+                break;
+                
+            case totemTypedArrayType_Int64:
+                val = ((int64_t*)arr->Data)[i];
+                break;
+                
+            default:
+                val = ((uint8_t*)arr->Data)[i];
+                break;
+        }
+        
+        keys[i] = ((uint64_t)val) ^ TOTEM_SORT_INTBIAS;
+    }
+    
+    totemExecStatus status = totemSort_Radix(state, keys, n);
+    if (status == totemExecStatus_Continue)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            int64_t val = (int64_t)(keys[i] ^ TOTEM_SORT_INTBIAS);
+            switch (arr->Type)
+            {
+                case totemTypedArrayType_Int32:
+                    ((int32_t*)arr->Data)[i] = (int32_t)val;
+                    break;
+                    
+                case totemTypedArrayType_Int64:
+                    ((int64_t*)arr->Data)[i] = val;
+                    break;
+                    
+                default:
+                    ((uint8_t*)arr->Data)[i] = (uint8_t)val;
+                    break;
+            }
+        }
+    }
+    
+    totemExecState_Free(state, keys, sizeof(uint64_t) * n);
+    return status;
+}
+
+static totemExecStatus totemSort_Array(totemExecState *state, totemGCObject *gc)
+{
+    totemRegister *regs = gc->Registers;
+    size_t n = gc->NumRegisters;
+    totemBool allInts = totemBool_True, allFloats = totemBool_True, allStrings = totemBool_True;
+    
+    if (n < 2)
+    {
+        return totemExecStatus_Continue;
+    }
+    
+    for (size_t i = 0; i < n; i++)
+    {
+        totemBool isInt = totemRegister_IsInt(&regs[i]);
+        totemBool isFloat = totemRegister_IsFloat(&regs[i]);
+        
+        allInts = allInts && isInt;
+        allFloats = allFloats && isFloat;
+        allStrings = allStrings && !isInt && !isFloat && totemRegister_IsString(&regs[i]);
+        
+        if (!allStrings && !isInt && !isFloat)
+        {
+            printf("expected numbers or strings sort\n");
+            return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+        }
+    }
+    
+    if (allStrings)
+    {
+        totemSort_Strings(NULL, regs, n);
+        return totemExecStatus_Continue;
+    }
+    
+    if (!allInts && !allFloats)
+    {
+        totemSort_Numbers(NULL, regs, n);
+        return totemExecStatus_Continue;
+    }
+    
+    // ints & floats are sorted unboxed, then written back
+    uint64_t *keys = totemExecState_Alloc(state, sizeof(uint64_t) * n);
+    if (!keys)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    totemExecStatus status = totemExecStatus_Continue;
+    
+    if (allInts)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            keys[i] = ((uint64_t)(int64_t)totemRegister_GetInt(&regs[i])) ^ TOTEM_SORT_INTBIAS;
+        }
+        
+        status = totemSort_Radix(state, keys, n);
+        if (status == totemExecStatus_Continue)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                totemExecState_AssignNewInt(state, &regs[i], (totemInt)(int64_t)(keys[i] ^ TOTEM_SORT_INTBIAS));
+            }
+        }
+    }
+    else
+    {
+        totemFloat *floats = (totemFloat*)keys;
+        for (size_t i = 0; i < n; i++)
+        {
+            floats[i] = totemRegister_GetFloat(&regs[i]);
+        }
+        
+        totemSort_Floats(NULL, floats, n);
+        
+        for (size_t i = 0; i < n; i++)
+        {
+            totemExecState_AssignNewFloat(state, &regs[i], floats[i]);
+        }
+    }
+    
+    totemExecState_Free(state, keys, sizeof(uint64_t) * n);
+    return status;
+}
+
+// sorts a private copy of arr, held in the return register, so the comparator can't resize or share what's being sorted
+static totemExecStatus totemSort_WithComparator(totemExecState *state, totemRegister *arrReg, totemRegister *comparator)
+{
+    totemGCObject *src = totemRegister_GetGCObject(arrReg);
+    totemGCObject *copy = NULL;
+    totemRegister *copyReg = state->CallStack->ReturnRegister;
+    totemExecStatus status = totemExecStatus_Continue;
+    
+    if (totemRegister_IsTypedArray(arrReg))
+    {
+        status = totemExecState_TypedArrayToArray(state, src->TypedArray, &copy);
+    }
+    else
+    {
+        status = totemExecState_CreateArrayFromExisting(state, src->Registers, src->NumRegisters, &copy);
+    }
+    
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    totemExecState_AssignNewArray(state, copyReg, copy);
+    
+    totemSortContext ctx;
+    ctx.State = state;
+    ctx.Comparator = comparator;
+    ctx.Status = totemExecStatus_Continue;
+    
+    totemSort_Comparator(&ctx, copy->Registers, copy->NumRegisters);
+    if (ctx.Status != totemExecStatus_Continue)
+    {
+        return ctx.Status;
+    }
+    
+    // the comparator may have changed arr in the meantime
+    if (totemRegister_IsTypedArray(arrReg))
+    {
+        if (src->TypedArray->Length != copy->NumRegisters)
+        {
+            return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+        }
+        
+        for (size_t i = 0; i < copy->NumRegisters; i++)
+        {
+            status = totemExecState_TypedArraySet(state, src->TypedArray, (totemInt)i, &copy->Registers[i]);
+            if (status != totemExecStatus_Continue)
+            {
+                return status;
+            }
+        }
+        
+        return totemExecStatus_Continue;
+    }
+    
+    if (src->NumRegisters != copy->NumRegisters)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    status = totemExecState_UnshareArray(state, src);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    for (size_t i = 0; i < copy->NumRegisters; i++)
+    {
+        totemExecState_Assign(state, &src->Registers[i], &copy->Registers[i]);
+    }
+    
+    totemExecState_WriteBarrier(state, src);
+    return totemExecStatus_Continue;
+}
+
+// sort(arr[, comparator]) - sorts arr in place & returns it, comparator(a, b) returns true when a belongs before b
+totemExecStatus totemSort(totemExecState *state)
+{
+    if (!state->CallStack->NumArguments)
+    {
+        printf("no arguments sort\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemRegister *arrReg = &state->LocalRegisters[0];
+    totemRegister *comparator = &state->LocalRegisters[1];
+    
+    if (!(totemRegister_IsArray(arrReg) || totemRegister_IsTypedArray(arrReg)))
+    {
+        printf("expected array sort\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemBool hasComparator = state->CallStack->NumArguments > 1;
+    if (hasComparator && !(totemRegister_IsInstanceFunction(comparator) || totemRegister_IsNativeFunction(comparator)))
+    {
+        printf("expected function comparator sort\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemGCObject *gc = totemRegister_GetGCObject(arrReg);
+    if (TOTEM_GCOBJECT_ISFROZEN(gc))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
+    
+    totemExecStatus status = totemExecStatus_Continue;
+    
+    if (hasComparator)
+    {
+        status = totemSort_WithComparator(state, arrReg, comparator);
+    }
+    else if (totemRegister_IsTypedArray(arrReg))
+    {
+        status = totemSort_TypedArray(state, gc->TypedArray);
+    }
+    else
+    {
+        status = totemExecState_UnshareArray(state, gc);
+        if (status == totemExecStatus_Continue)
+        {
+            status = totemSort_Array(state, gc);
+            totemExecState_WriteBarrier(state, gc);
+        }
+    }
+    
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    totemExecState_Assign(state, state->CallStack->ReturnRegister, arrReg);
+    return totemExecStatus_Continue;
+}
+
 void totemFileDestructor(totemExecState *state, void *data)
 {
-    fclose((FILE*)data);
+    // fclose may have got here first
+    if (data)
+    {
+        fclose((FILE*)data);
+    }
+}
+
+static totemExecStatus totemFile_Get(totemRegister *reg, const char *name, totemGCObject **gcOut)
+{
+    if (!totemRegister_IsUserdata(reg) || totemRegister_GetGCObject(reg)->UserdataDestructor != totemFileDestructor)
+    {
+        printf("expected file %s\n", name);
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    totemGCObject *gc = totemRegister_GetGCObject(reg);
+    if (!gc->Userdata)
+    {
+        printf("file already closed %s\n", name);
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    *gcOut = gc;
+    return totemExecStatus_Continue;
 }
 
 totemExecStatus totemFOpen(totemExecState *state)
@@ -145,9 +1130,150 @@ totemExecStatus totemFOpen(totemExecState *state)
     return status;
 }
 
+// fread(file, length) - reads up to length bytes into a uint8array, or the rest of the file when length is left out
+totemExecStatus totemFRead(totemExecState *state)
+{
+    if (!state->CallStack->NumArguments)
+    {
+        printf("no arguments fread\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemGCObject *file = NULL;
+    totemExecStatus status = totemFile_Get(&state->LocalRegisters[0], "fread", &file);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    totemInt length = -1;
+    if (state->CallStack->NumArguments > 1)
+    {
+        if (!totemRegister_IsInt(&state->LocalRegisters[1]))
+        {
+            printf("expected int length fread\n");
+            return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+        }
+        
+        length = totemRegister_GetInt(&state->LocalRegisters[1]);
+        if (length < 0)
+        {
+            return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+        }
+    }
+    
+    totemGCObject *gc = NULL;
+    status = totemExecState_CreateTypedArray(state, totemTypedArrayType_Uint8, 0, &gc);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    // assign straight away, so the buffer stays reachable however many times it grows
+    totemExecState_AssignNewTypedArray(state, state->CallStack->ReturnRegister, gc);
+    
+    size_t capacity = length >= 0 ? (size_t)length : 4096;
+    
+    while (capacity)
+    {
+        status = totemExecState_ReserveTypedArray(state, gc, capacity);
+        if (status != totemExecStatus_Continue)
+        {
+            return status;
+        }
+        
+        totemTypedArray *arr = gc->TypedArray;
+        size_t wanted = arr->Capacity - arr->Length;
+        size_t numRead = fread(((uint8_t*)arr->Data) + arr->Length, 1, wanted, (FILE*)file->Userdata);
+        arr->Length += numRead;
+        
+        if (numRead < wanted || length >= 0)
+        {
+            break;
+        }
+        
+        capacity *= 2;
+    }
+    
+    return totemExecStatus_Continue;
+}
+
+// fwrite(file, value) - writes the bytes of a string or typed array, returning how many were written
+totemExecStatus totemFWrite(totemExecState *state)
+{
+    if (state->CallStack->NumArguments < 2)
+    {
+        printf("no arguments fwrite\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemGCObject *file = NULL;
+    totemExecStatus status = totemFile_Get(&state->LocalRegisters[0], "fwrite", &file);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    totemRegister *valReg = &state->LocalRegisters[1];
+    const void *data = NULL;
+    size_t numBytes = 0;
+    
+    if (totemRegister_IsTypedArray(valReg))
+    {
+        totemTypedArray *arr = totemRegister_GetGCObject(valReg)->TypedArray;
+        data = arr->Data;
+        numBytes = totemTypedArrayType_GetElementSize(arr->Type) * arr->Length;
+    }
+    else if (totemRegister_IsString(valReg))
+    {
+        totemRuntimeStringValue val;
+        totemRegister_GetStringValue(valReg, &val);
+        data = val.Value;
+        numBytes = totemRegister_GetStringLength(valReg);
+    }
+    else
+    {
+        printf("expected string or typed array fwrite\n");
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+    }
+    
+    size_t numWritten = fwrite(data, 1, numBytes, (FILE*)file->Userdata);
+    totemExecState_AssignNewInt(state, state->CallStack->ReturnRegister, (totemInt)numWritten);
+    return totemExecStatus_Continue;
+}
+
+// fclose(file) - files are closed when collected anyway, this just doesn't wait
+totemExecStatus totemFClose(totemExecState *state)
+{
+    if (!state->CallStack->NumArguments)
+    {
+        printf("no arguments fclose\n");
+        return totemExecStatus_Break(totemExecStatus_Stop);
+    }
+    
+    totemGCObject *file = NULL;
+    totemExecStatus status = totemFile_Get(&state->LocalRegisters[0], "fclose", &file);
+    if (status != totemExecStatus_Continue)
+    {
+        return status;
+    }
+    
+    fclose((FILE*)file->Userdata);
+    file->Userdata = NULL;
+    return totemExecStatus_Continue;
+}
+
 totemExecStatus totemGCCollect(totemExecState *state)
 {
-    totemExecState_CollectGarbage(state, state->CallStack->NumArguments ? !totemRegister_IsZero(&state->LocalRegisters[0]) : totemBool_False);
+    totemBool full = state->CallStack->NumArguments ? !totemRegister_IsZero(&state->LocalRegisters[0]) : totemBool_False;
+    totemExecState_CollectGarbage(state, full);
+    
+    // full collections are a good opportunity to hand memory back after a spike
+    if (full)
+    {
+        totem_TrimMemory();
+    }
+    
     return totemExecStatus_Continue;
 }
 
@@ -164,10 +1290,25 @@ totemLinkStatus totemRuntime_LinkStdLib(totemRuntime *runtime)
         { totemPrint, TOTEM_STRING_VAL("print") },
         { totemAssert, TOTEM_STRING_VAL("assert") },
         { totemFOpen, TOTEM_STRING_VAL("fopen") },
+        { totemFRead, TOTEM_STRING_VAL("fread") },
+        { totemFWrite, TOTEM_STRING_VAL("fwrite") },
+        { totemFClose, TOTEM_STRING_VAL("fclose") },
         { totemGCCollect, TOTEM_STRING_VAL("gc_collect") },
         { totemGCNum, TOTEM_STRING_VAL("gc_num") },
         { totemSqrt, TOTEM_STRING_VAL("sqrt") },
-        { totemArgV, TOTEM_STRING_VAL("argv") }
+        { totemArgV, TOTEM_STRING_VAL("argv") },
+        { totemSubstring, TOTEM_STRING_VAL("substring") },
+        { totemByte, TOTEM_STRING_VAL("byte") },
+        { totemFloat64Array, TOTEM_STRING_VAL("float64array") },
+        { totemInt32Array, TOTEM_STRING_VAL("int32array") },
+        { totemInt64Array, TOTEM_STRING_VAL("int64array") },
+        { totemUint8Array, TOTEM_STRING_VAL("uint8array") },
+        { totemPush, TOTEM_STRING_VAL("push") },
+        { totemPop, TOTEM_STRING_VAL("pop") },
+        { totemReserve, TOTEM_STRING_VAL("reserve") },
+        { totemSlice, TOTEM_STRING_VAL("slice") },
+        { totemFreeze, TOTEM_STRING_VAL("freeze") },
+        { totemSort, TOTEM_STRING_VAL("sort") }
     };
     
     return totemRuntime_LinkNativeFunctions(runtime, funcs, TOTEM_ARRAY_SIZE(funcs));
@@ -14,6 +14,8 @@
 #define totemRegister_Assert(x)
 #endif
 
+static totemBool totemRegister_RopeEquals(totemRegister *a, totemRegister *b);
+
 #if TOTEM_VMOPT_NANBOXING
 
 #define TOTEM_FLOAT_QUIET_NAN_MASK TOTEM_BITMASK(uint64_t, 51, 12)
@@ -37,7 +39,9 @@ void totemRegister_AssertValue(totemRegister *reg)
                           type == totemPrivateDataType_Null ||
                           type == totemPrivateDataType_Object ||
                           type == totemPrivateDataType_Type ||
-                          type == totemPrivateDataType_Userdata);
+                          type == totemPrivateDataType_Userdata ||
+                          type == totemPrivateDataType_Rope ||
+                          type == totemPrivateDataType_TypedArray);
     
     if (!goodType)
     {
@@ -69,6 +73,10 @@ void totemRegister_AssertValue(totemRegister *reg)
         printf(" type\n");
         totem_printBits(stdout, totemPrivateDataType_Userdata, 64, 0);
         printf(" userdata\n");
+        totem_printBits(stdout, totemPrivateDataType_Rope, 64, 0);
+        printf(" rope\n");
+        totem_printBits(stdout, totemPrivateDataType_TypedArray, 64, 0);
+        printf(" typed array\n");
         
         totem_assert(totemBool_False);
     }
@@ -143,7 +151,7 @@ totemBool totemRegister_IsGarbageCollected(totemRegister *reg)
 
 totemBool totemRegister_Equals(totemRegister *a, totemRegister *b)
 {
-    return a->AsBits == b->AsBits;
+    return a->AsBits == b->AsBits || totemRegister_RopeEquals(a, b);
 }
 
 totemNativeFunction *totemRegister_GetNativeFunction(totemRegister *reg)
@@ -265,6 +273,24 @@ void totemRegister_SetUserdata(totemRegister *dst, totemGCObject *val)
     totem_assert(totemRegister_IsUserdata(dst));
 }
 
+void totemRegister_SetRope(totemRegister *dst, totemGCObject *val)
+{
+    uint64_t b = TOTEM_BITCAST(uint64_t, val);
+    dst->AsBits = TOTEM_REGISTER_NAN_VALUE(totemPrivateDataType_Rope, b);
+    totem_assert(totemRegister_GetType(dst) == totemPrivateDataType_Rope);
+    totem_assert(totemRegister_GetGCObject(dst) == val);
+    totem_assert(totemRegister_IsRope(dst));
+}
+
+void totemRegister_SetTypedArray(totemRegister *dst, totemGCObject *val)
+{
+    uint64_t b = TOTEM_BITCAST(uint64_t, val);
+    dst->AsBits = TOTEM_REGISTER_NAN_VALUE(totemPrivateDataType_TypedArray, b);
+    totem_assert(totemRegister_GetType(dst) == totemPrivateDataType_TypedArray);
+    totem_assert(totemRegister_GetGCObject(dst) == val);
+    totem_assert(totemRegister_IsTypedArray(dst));
+}
+
 void totemRegister_SetBoolean(totemRegister *dst, totemBool val)
 {
     uint64_t b = val != totemBool_False;
@@ -349,7 +375,7 @@ totemBool totemRegister_IsNotZero(totemRegister *reg)
 totemBool totemRegister_IsGarbageCollected(totemRegister *reg)
 {
     totemPrivateDataType type = totemRegister_GetType(reg);
-    return type >= totemPrivateDataType_Array && type <= totemPrivateDataType_Userdata;
+    return (type >= totemPrivateDataType_Array && type <= totemPrivateDataType_Userdata) || type == totemPrivateDataType_Rope || type == totemPrivateDataType_TypedArray;
 }
 
 totemBool totemRegister_IsType(totemRegister *reg, totemPrivateDataType type)
@@ -364,7 +390,7 @@ totemBool totemRegister_IsFloat(totemRegister *reg)
 
 totemBool totemRegister_Equals(totemRegister *a, totemRegister *b)
 {
-    return a->DataType == b->DataType && a->Value.Data == b->Value.Data;
+    return (a->DataType == b->DataType && a->Value.Data == b->Value.Data) || totemRegister_RopeEquals(a, b);
 }
 
 totemNativeFunction *totemRegister_GetNativeFunction(totemRegister *reg)
@@ -447,6 +473,18 @@ void totemRegister_SetUserdata(totemRegister *dst, totemGCObject *val)
     dst->Value.GCObject = val;
 }
 
+void totemRegister_SetRope(totemRegister *dst, totemGCObject *val)
+{
+    dst->DataType = totemPrivateDataType_Rope;
+    dst->Value.GCObject = val;
+}
+
+void totemRegister_SetTypedArray(totemRegister *dst, totemGCObject *val)
+{
+    dst->DataType = totemPrivateDataType_TypedArray;
+    dst->Value.GCObject = val;
+}
+
 void totemRegister_SetBoolean(totemRegister *dst, totemBool val)
 {
     dst->DataType = totemPrivateDataType_Boolean;
@@ -474,7 +512,7 @@ totemBool totemRegister_IsNull(totemRegister *reg)
 
 totemBool totemRegister_IsString(totemRegister *reg)
 {
-    return totemRegister_IsInternedString(reg) || totemRegister_IsMiniString(reg);
+    return totemRegister_IsInternedString(reg) || totemRegister_IsMiniString(reg) || totemRegister_IsRope(reg);
 }
 
 totemBool totemRegister_IsTypeValue(totemRegister *reg)
@@ -492,6 +530,11 @@ totemBool totemRegister_IsArray(totemRegister *reg)
     return totemRegister_IsType(reg, totemPrivateDataType_Array);
 }
 
+totemBool totemRegister_IsTypedArray(totemRegister *reg)
+{
+    return totemRegister_IsType(reg, totemPrivateDataType_TypedArray);
+}
+
 totemBool totemRegister_IsObject(totemRegister *reg)
 {
     return totemRegister_IsType(reg, totemPrivateDataType_Object);
@@ -532,6 +575,32 @@ totemBool totemRegister_IsMiniString(totemRegister *reg)
     return totemRegister_IsType(reg, totemPrivateDataType_MiniString);
 }
 
+totemBool totemRegister_IsRope(totemRegister *reg)
+{
+    return totemRegister_IsType(reg, totemPrivateDataType_Rope);
+}
+
+// the same string may be held both as a rope & interned, so ropes compare by value
+static totemBool totemRegister_RopeEquals(totemRegister *a, totemRegister *b)
+{
+    if (!(totemRegister_IsRope(a) || totemRegister_IsRope(b)) || !totemRegister_IsString(a) || !totemRegister_IsString(b))
+    {
+        return totemBool_False;
+    }
+    
+    totemStringLength len = totemRegister_GetStringLength(a);
+    if (len != totemRegister_GetStringLength(b))
+    {
+        return totemBool_False;
+    }
+    
+    totemRuntimeStringValue aVal, bVal;
+    totemRegister_GetStringValue(a, &aVal);
+    totemRegister_GetStringValue(b, &bVal);
+    
+    return memcmp(aVal.Value, bVal.Value, len) == 0;
+}
+
 void totemExecState_Assign(totemExecState *state, totemRegister *dst, totemRegister *src)
 {
     totemExecState_DecRefCount(state, dst);
@@ -609,6 +678,20 @@ void totemExecState_AssignNewUserdata(totemExecState *state, totemRegister *dst,
     totemRegister_Assert(dst);
 }
 
+void totemExecState_AssignNewRope(totemExecState *state, totemRegister *dst, totemGCObject *newVal)
+{
+    totemExecState_DecRefCount(state, dst);
+    totemRegister_SetRope(dst, newVal);
+    totemRegister_Assert(dst);
+}
+
+void totemExecState_AssignNewTypedArray(totemExecState *state, totemRegister *dst, totemGCObject *newVal)
+{
+    totemExecState_DecRefCount(state, dst);
+    totemRegister_SetTypedArray(dst, newVal);
+    totemRegister_Assert(dst);
+}
+
 void totemExecState_AssignNewString(totemExecState *state, totemRegister *dst, totemRuntimeStringValue *src)
 {
     totemExecState_DecRefCount(state, dst);
@@ -651,6 +734,10 @@ totemStringLength totemRegister_GetStringLength(totemRegister *reg)
         totemRegister_GetMiniString(reg, val);
         return totemMiniString_GetLength(val);
     }
+    else if (totemRegister_IsRope(reg))
+    {
+        return totemRegister_GetGCObject(reg)->Rope->Length;
+    }
     else
     {
         return 0;
@@ -670,6 +757,11 @@ totemHash totemRegister_GetStringHash(totemRegister *reg)
         totemRegister_GetMiniString(reg, val);
         return totem_Hash(val, totemMiniString_GetLength(val));
     }
+    else if (totemRegister_IsRope(reg))
+    {
+        totemRope *rope = totemRegister_GetGCObject(reg)->Rope;
+        return rope->Flattened ? rope->Flattened->Hash : totem_Hash(totemRope_GetData(rope), rope->Length);
+    }
     else
     {
         return 0;
@@ -690,6 +782,23 @@ void totemRegister_GetStringValue(totemRegister *src, totemRuntimeStringValue *v
         totemRegister_GetMiniString(src, val->MiniString);
         val->Value = val->MiniString;
     }
+    else if (totemRegister_IsRope(src))
+    {
+        totemRope *rope = totemRegister_GetGCObject(src)->Rope;
+        if (rope->Flattened)
+        {
+            val->Type = totemPrivateDataType_InternedString;
+            val->InternedString = rope->Flattened;
+            val->Value = rope->Flattened->Data;
+        }
+        else
+        {
+            // not nul-terminated - flatten first if that matters
+            val->Type = totemPrivateDataType_Rope;
+            val->InternedString = NULL;
+            val->Value = totemRope_GetData(rope);
+        }
+    }
     else
     {
         val->Value = NULL;
@@ -757,30 +866,52 @@ void totemExecState_PrintRegisterRecursive(totemExecState *state, FILE *file, to
             break;
         }
             
+        case totemPrivateDataType_Rope:
+        {
+            totemRuntimeStringValue val;
+            totemRegister_GetStringValue(reg, &val);
+            
+            fprintf(file, "%s \"%.*s\" \n",
+                    totemPrivateDataType_Describe(type),
+                    (int)totemRegister_GetStringLength(reg),
+                    val.Value);
+            break;
+        }
+            
         case totemPrivateDataType_Object:
         {
             indent += 5;
             totemGCObject *gc = totemRegister_GetGCObject(reg);
-            totemHashMap *obj = gc->Object;
+            totemObject *obj = gc->Object;
             
             fprintf(file, "object {\n");
             
-            for (size_t i = 0; i < obj->NumBuckets; i++)
+            for (size_t pair = 0; pair < obj->NumPairs; pair++)
             {
-                totemHashMapEntry *entry = obj->Buckets[i];
+                totemRegister *key = TOTEM_OBJECT_KEY(gc, pair);
+                if (totemRegister_IsNull(key))
+                {
+                    continue;
+                }
                 
-                while (entry)
+                for (size_t i = 0; i < indent; i++)
                 {
-                    for (size_t i = 0; i < indent; i++)
-                    {
-                        fprintf(file, " ");
-                    }
-                    
-                    fprintf(file, "\"%.*s\": ", (int)entry->KeyLen, (char*)entry->Key);
-                    totemExecState_PrintRegisterRecursive(state, file, gc->Registers + entry->Value, indent);
+                    fprintf(file, " ");
+                }
+                
+                if (totemRegister_IsInt(key))
+                {
+                    fprintf(file, "\"%"TOTEM_INT_PRINTF"\": ", totemRegister_GetInt(key));
+                }
+                else
+                {
+                    totemRuntimeStringValue keyVal;
+                    totemRegister_GetStringValue(key, &keyVal);
                     
-                    entry = entry->Next;
+                    fprintf(file, "\"%.*s\": ", (int)totemRegister_GetStringLength(key), keyVal.Value);
                 }
+                
+                totemExecState_PrintRegisterRecursive(state, file, TOTEM_OBJECT_VALUE(gc, pair), indent);
             }
             
             indent -= 5;
@@ -826,6 +957,39 @@ void totemExecState_PrintRegisterRecursive(totemExecState *state, FILE *file, to
             break;
         }
             
+        case totemPrivateDataType_TypedArray:
+        {
+            indent += 5;
+            totemTypedArray *arr = totemRegister_GetGCObject(reg)->TypedArray;
+            
+            fprintf(file, "%s[%"PRISize"] {\n", totemTypedArrayType_Describe(arr->Type), arr->Length);
+            
+            for (size_t i = 0; i < arr->Length; ++i)
+            {
+                for (size_t j = 0; j < indent; j++)
+                {
+                    fprintf(file, " ");
+                }
+                
+                fprintf(file, "%"PRISize": ", i);
+                
+                totemRegister val;
+                totemRegister_SetNull(&val);
+                totemExecState_TypedArrayGet(state, arr, (totemInt)i, &val);
+                totemExecState_PrintRegisterRecursive(state, file, &val, indent);
+            }
+            
+            indent -= 5;
+            
+            for (size_t i = 0; i < indent; i++)
+            {
+                fprintf(file, " ");
+            }
+            
+            fprintf(file, "}\n");
+            break;
+        }
+            
         case totemPrivateDataType_Float:
             fprintf(file, "%s %f\n", totemPrivateDataType_Describe(type), totemRegister_GetFloat(reg));
             break;
@@ -16,6 +16,7 @@ totemPublicDataType totemPrivateDataType_ToPublic(totemPrivateDataType type)
     {
         case totemPrivateDataType_InternedString:
         case totemPrivateDataType_MiniString:
+        case totemPrivateDataType_Rope:
             return totemPublicDataType_String;
             
         case totemPrivateDataType_Float:
@@ -32,6 +33,7 @@ totemPublicDataType totemPrivateDataType_ToPublic(totemPrivateDataType type)
             return totemPublicDataType_Function;
             
         case totemPrivateDataType_Array:
+        case totemPrivateDataType_TypedArray:
             return totemPublicDataType_Array;
             
         case totemPrivateDataType_Coroutine:
@@ -81,6 +83,11 @@ totemExecStatus totemExecState_Add(totemExecState *state, totemRegister *destina
         case TOTEM_TYPEPAIR(totemPrivateDataType_InternedString, totemPrivateDataType_MiniString):
         case TOTEM_TYPEPAIR(totemPrivateDataType_MiniString, totemPrivateDataType_InternedString):
         case TOTEM_TYPEPAIR(totemPrivateDataType_InternedString, totemPrivateDataType_InternedString):
+        case TOTEM_TYPEPAIR(totemPrivateDataType_Rope, totemPrivateDataType_MiniString):
+        case TOTEM_TYPEPAIR(totemPrivateDataType_Rope, totemPrivateDataType_InternedString):
+        case TOTEM_TYPEPAIR(totemPrivateDataType_Rope, totemPrivateDataType_Rope):
+        case TOTEM_TYPEPAIR(totemPrivateDataType_MiniString, totemPrivateDataType_Rope):
+        case TOTEM_TYPEPAIR(totemPrivateDataType_InternedString, totemPrivateDataType_Rope):
             return totemExecState_ConcatStrings(state, source1, source2, destination);
             break;
             
@@ -324,120 +331,665 @@ totemExecStatus totemExecState_ArrayGet(totemExecState *state, totemRegister *ar
     return totemExecStatus_Continue;
 }
 
-totemExecStatus totemExecState_ObjectShift(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *dst)
+totemExecStatus totemExecState_ArrayPush(totemExecState *state, totemGCObject *gc, totemRegister *src)
 {
-    totemRegister actualKey;
-    
-    if (!totemRegister_IsString(key))
+    if (TOTEM_GCOBJECT_ISFROZEN(gc))
     {
-        TOTEM_EXEC_CHECKRETURN(totemExecState_ToString(state, key, &actualKey));
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
     }
-    else
+    
+    TOTEM_EXEC_CHECKRETURN(totemExecState_UnshareArray(state, gc));
+    
+    // double capacity as we go, so pushing n values only reallocates log(n) times
+    if (gc->NumRegisters == gc->ArrayCapacity)
     {
-        actualKey = *key;
+        TOTEM_EXEC_CHECKRETURN(totemExecState_ReserveArray(state, gc, gc->ArrayCapacity ? gc->ArrayCapacity * 2 : 8));
     }
     
-    totemHash hash = totemRegister_GetStringHash(&actualKey);
+    totemExecState_Assign(state, &gc->Registers[gc->NumRegisters], src);
+    gc->NumRegisters++;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_ArrayPop(totemExecState *state, totemGCObject *gc, totemRegister *dst)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(gc))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
     
-    totemHashMapEntry *result = totemHashMap_RemovePrecomputed(obj->Object, &actualKey, sizeof(actualKey), hash);
-    if (!result)
+    if (!gc->NumRegisters)
     {
         totemExecState_AssignNull(state, dst);
+        return totemExecStatus_Continue;
     }
-    else
+    
+    TOTEM_EXEC_CHECKRETURN(totemExecState_UnshareArray(state, gc));
+    
+    // capacity is kept, so a following push doesn't reallocate
+    gc->NumRegisters--;
+    totemRegister *src = &gc->Registers[gc->NumRegisters];
+    totemExecState_Assign(state, dst, src);
+    totemExecState_AssignNull(state, src);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_TypedArrayGet(totemExecState *state, totemTypedArray *arr, totemInt index, totemRegister *dst)
+{
+    if (index < 0 || ((size_t)index) >= arr->Length)
     {
-        totemExecState_Assign(state, dst, obj->Registers + result->Value);
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    switch (arr->Type)
+    {
+        case totemTypedArrayType_Float64:
+            totemExecState_AssignNewFloat(state, dst, ((double*)arr->Data)[index]);
+            break;
+        
+        case totemTypedArrayType_Int32:
+            totemExecState_AssignNewInt(state, dst, ((int32_t*)arr->Data)[index]);
+            break;
+        
+        case totemTypedArrayType_Int64:
+            totemExecState_AssignNewInt(state, dst, (totemInt)((int64_t*)arr->Data)[index]);
+            break;
+        
+        case totemTypedArrayType_Uint8:
+            totemExecState_AssignNewInt(state, dst, ((uint8_t*)arr->Data)[index]);
+            break;
+        
+        default:
+            return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
     }
     
     return totemExecStatus_Continue;
 }
 
-totemExecStatus totemExecState_ObjectGet(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *dst)
+totemExecStatus totemExecState_TypedArraySet(totemExecState *state, totemTypedArray *arr, totemInt index, totemRegister *src)
 {
-    totemRegister actualKey;
+    if (index < 0 || ((size_t)index) >= arr->Length)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
     
-    if (!totemRegister_IsString(key))
+    if (totemRegister_IsFloat(src))
     {
-        TOTEM_EXEC_CHECKRETURN(totemExecState_ToString(state, key, &actualKey));
+        totemFloat val = totemRegister_GetFloat(src);
+        
+        switch (arr->Type)
+        {
+            case totemTypedArrayType_Float64:
+                ((double*)arr->Data)[index] = val;
+                break;
+            
+            case totemTypedArrayType_Int32:
+                ((int32_t*)arr->Data)[index] = (int32_t)val;
+                break;
+            
+            case totemTypedArrayType_Int64:
+                ((int64_t*)arr->Data)[index] = (int64_t)val;
+                break;
+            
+            case totemTypedArrayType_Uint8:
+                ((uint8_t*)arr->Data)[index] = (uint8_t)(int64_t)val;
+                break;
+            
+            default:
+                return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+        }
+    }
+    else if (totemRegister_IsInt(src))
+    {
+        totemInt val = totemRegister_GetInt(src);
+        
+        switch (arr->Type)
+        {
+            case totemTypedArrayType_Float64:
+                ((double*)arr->Data)[index] = (double)val;
+                break;
+            
+            case totemTypedArrayType_Int32:
+                ((int32_t*)arr->Data)[index] = (int32_t)val;
+                break;
+            
+            case totemTypedArrayType_Int64:
+                ((int64_t*)arr->Data)[index] = val;
+                break;
+            
+            case totemTypedArrayType_Uint8:
+                ((uint8_t*)arr->Data)[index] = (uint8_t)val;
+                break;
+            
+            default:
+                return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
+        }
     }
     else
     {
-        actualKey = *key;
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
     }
     
-    totemHash hash = totemRegister_GetStringHash(&actualKey);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_TypedArrayShift(totemExecState *state, totemTypedArray *arr, totemInt index, totemRegister *dst)
+{
+    TOTEM_EXEC_CHECKRETURN(totemExecState_TypedArrayGet(state, arr, index, dst));
+    
+    // elements can't be null, so shifting one out leaves a zero behind
+    size_t elementSize = totemTypedArrayType_GetElementSize(arr->Type);
+    memset(((char*)arr->Data) + (elementSize * (size_t)index), 0, elementSize);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_TypedArrayPush(totemExecState *state, totemGCObject *gc, totemRegister *src)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(gc))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
+    
+    // double capacity as we go, just like arrays
+    if (gc->TypedArray->Length == gc->TypedArray->Capacity)
+    {
+        TOTEM_EXEC_CHECKRETURN(totemExecState_ReserveTypedArray(state, gc, gc->TypedArray->Capacity ? gc->TypedArray->Capacity * 2 : 8));
+    }
+    
+    totemTypedArray *arr = gc->TypedArray;
+    arr->Length++;
+    
+    totemExecStatus status = totemExecState_TypedArraySet(state, arr, (totemInt)(arr->Length - 1), src);
+    if (status != totemExecStatus_Continue)
+    {
+        arr->Length--;
+    }
+    
+    return status;
+}
+
+totemExecStatus totemExecState_TypedArrayPop(totemExecState *state, totemGCObject *gc, totemRegister *dst)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(gc))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
     
-    totemHashMapEntry *result = totemHashMap_FindPrecomputed(obj->Object, &actualKey, sizeof(actualKey), hash);
-    if (!result)
+    totemTypedArray *arr = gc->TypedArray;
+    if (!arr->Length)
     {
         totemExecState_AssignNull(state, dst);
+        return totemExecStatus_Continue;
     }
-    else
+    
+    // capacity is kept, and the element zeroed so a following push finds it as it would a new one
+    TOTEM_EXEC_CHECKRETURN(totemExecState_TypedArrayShift(state, arr, (totemInt)(arr->Length - 1), dst));
+    arr->Length--;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_SliceTypedArray(totemExecState *state, totemTypedArray *arr, size_t offset, size_t length, totemGCObject **gcOut)
+{
+    if (offset > arr->Length || length > arr->Length - offset)
     {
-        totemExecState_Assign(state, dst, obj->Registers + result->Value);
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
     }
     
+    totemGCObject *gc = NULL;
+    TOTEM_EXEC_CHECKRETURN(totemExecState_CreateTypedArray(state, arr->Type, (totemInt)length, &gc));
+    
+    size_t elementSize = totemTypedArrayType_GetElementSize(arr->Type);
+    memcpy(gc->TypedArray->Data, ((char*)arr->Data) + (elementSize * offset), elementSize * length);
+    
+    *gcOut = gc;
     return totemExecStatus_Continue;
 }
 
-totemExecStatus totemExecState_ObjectSet(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *src)
+totemExecStatus totemExecState_TypedArrayToArray(totemExecState *state, totemTypedArray *arr, totemGCObject **gcOut)
 {
-    totemRegister actualKey;
+    totemGCObject *gc = NULL;
+    TOTEM_EXEC_CHECKRETURN(totemExecState_CreateArray(state, (totemInt)arr->Length, &gc));
+    
+    for (size_t i = 0; i < arr->Length; i++)
+    {
+        TOTEM_EXEC_CHECKRETURN(totemExecState_TypedArrayGet(state, arr, (totemInt)i, &gc->Registers[i]));
+    }
+    
+    *gcOut = gc;
+    return totemExecStatus_Continue;
+}
+
+// object keys are always ints or flattened strings, so are equal exactly when their type & value bits are
+typedef struct
+{
+    uint64_t Bits;
+#if !TOTEM_VMOPT_NANBOXING
+    uint64_t Type;
+#endif
+}
+totemObjectKey;
+
+static inline TOTEM_INLINE void totemObjectKey_Init(totemObjectKey *dst, totemRegister *key)
+{
+#if TOTEM_VMOPT_NANBOXING
+    dst->Bits = key->AsBits;
+#else
+    dst->Bits = key->Value.Data;
+    dst->Type = key->DataType;
+#endif
+}
+
+static inline TOTEM_INLINE totemBool totemObjectKey_Equals(totemRegister *a, totemRegister *b)
+{
+#if TOTEM_VMOPT_NANBOXING
+    return a->AsBits == b->AsBits;
+#else
+    return a->Value.Data == b->Value.Data && a->DataType == b->DataType;
+#endif
+}
+
+// true when str is exactly what IntToString would produce for some integer
+static totemBool totemObject_ParseIntKey(const char *str, size_t len, totemInt *valOut)
+{
+    totemBool negative = totemBool_False;
+    if (len && str[0] == '-')
+    {
+        negative = totemBool_True;
+        str++;
+        len--;
+    }
+    
+    // no leading zeroes, and no "-0"
+    if (!len || str[0] < '0' || str[0] > '9' || (str[0] == '0' && (len > 1 || negative)))
+    {
+        return totemBool_False;
+    }
+    
+    uint64_t limit = negative ? ((uint64_t)TOTEM_INT_MAX) + 1 : (uint64_t)TOTEM_INT_MAX;
+    uint64_t val = 0;
+    
+    for (size_t i = 0; i < len; i++)
+    {
+        if (str[i] < '0' || str[i] > '9')
+        {
+            return totemBool_False;
+        }
+        
+        uint64_t digit = (uint64_t)(str[i] - '0');
+        if (val > (limit - digit) / 10)
+        {
+            return totemBool_False;
+        }
+        
+        val = (val * 10) + digit;
+    }
+    
+    *valOut = negative ? (totemInt)(0 - val) : (totemInt)val;
+    return totemBool_True;
+}
+
+// integer keys are used as-is, and strings spelling out an integer become that integer, so obj[1] & obj["1"] still match without formatting anything
+static totemExecStatus totemExecState_ToObjectKey(totemExecState *state, totemRegister *key, totemRegister *keyOut)
+{
+    if (totemRegister_IsInt(key))
+    {
+        totemRegister_SetInt(keyOut, totemRegister_GetInt(key));
+        return totemExecStatus_Continue;
+    }
     
     if (!totemRegister_IsString(key))
     {
-        TOTEM_EXEC_CHECKRETURN(totemExecState_ToString(state, key, &actualKey));
+        TOTEM_EXEC_CHECKRETURN(totemExecState_ToString(state, key, keyOut));
     }
     else
     {
-        actualKey = *key;
+        TOTEM_EXEC_CHECKRETURN(totemExecState_FlattenString(state, key, keyOut));
     }
     
-    totemHash hash = totemRegister_GetStringHash(&actualKey);
-    totemHashValue registerIndex = 0;
-    totemHashMapEntry *entry = totemHashMap_FindPrecomputed(obj->Object, &actualKey, sizeof(actualKey), hash);
+    totemRuntimeStringValue val;
+    totemRegister_GetStringValue(keyOut, &val);
     
-    if (entry)
+    totemInt intKey = 0;
+    if (totemObject_ParseIntKey(val.Value, totemRegister_GetStringLength(keyOut), &intKey))
     {
-        // already in hash map
-        registerIndex = entry->Value;
+        totemRegister_SetInt(keyOut, intKey);
     }
-    else
+    
+    return totemExecStatus_Continue;
+}
+
+static inline TOTEM_INLINE totemHash totemObject_GetKeyHash(totemRegister *key)
+{
+    if (totemRegister_IsInt(key))
+    {
+        // fibonacci hashing, the hashmap takes both the low & high bits of the result
+        uint64_t mixed = ((uint64_t)totemRegister_GetInt(key)) * UINT64_C(0x9E3779B97F4A7C15);
+        return (totemHash)(mixed >> 32);
+    }
+    
+    return totemRegister_GetStringHash(key);
+}
+
+static totemBool totemObject_FindPair(totemGCObject *gc, totemRegister *key, size_t *pairOut)
+{
+    totemObject *obj = gc->Object;
+    
+    if (obj->Lookup)
     {
-        totemBool expanded = totemBool_False;
+        totemObjectKey lookupKey;
+        totemObjectKey_Init(&lookupKey, key);
         
-        // we need to insert a new lookup value
-        if (obj->Object->FreeList)
+        totemHashMapEntry *entry = totemHashMap_FindPrecomputed(obj->Lookup, &lookupKey, sizeof(lookupKey), totemObject_GetKeyHash(key));
+        if (!entry)
         {
-            // we can reuse the register index sitting on top of the freelist
-            registerIndex = obj->Object->FreeList->Value;
+            return totemBool_False;
         }
-        else
+        
+        *pairOut = entry->Value;
+        return totemBool_True;
+    }
+    
+    for (size_t i = 0; i < obj->NumPairs; i++)
+    {
+        if (totemObjectKey_Equals(TOTEM_OBJECT_KEY(gc, i), key))
         {
-            expanded = totemBool_True;
-            
-            // otherwise we need a new one
-            registerIndex = obj->NumRegisters;
-            
-            if (!totemExecState_ExpandGCObject(state, obj))
+            *pairOut = i;
+            return totemBool_True;
+        }
+    }
+    
+    return totemBool_False;
+}
+
+// past TOTEM_EXEC_SMALLOBJECTKEYS, build a lookup from the pairs scanned so far
+static totemExecStatus totemExecState_PromoteObject(totemExecState *state, totemGCObject *gc)
+{
+    totemObject *obj = gc->Object;
+    
+    totemHashMap *lookup = totemExecState_Alloc(state, sizeof(totemHashMap));
+    if (!lookup)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
+    
+    totemHashMap_Init(lookup);
+    lookup->Allocator = &state->Allocator;
+    
+    // close up any gaps left by removed keys while we're at it, lookups don't track them
+    size_t numPairs = 0;
+    for (size_t i = 0; i < obj->NumPairs; i++)
+    {
+        totemRegister *key = TOTEM_OBJECT_KEY(gc, i);
+        if (totemRegister_IsNull(key))
+        {
+            continue;
+        }
+        
+        if (i != numPairs)
+        {
+            // a straight move, so no reference counts change hands
+            *TOTEM_OBJECT_KEY(gc, numPairs) = *key;
+            *TOTEM_OBJECT_VALUE(gc, numPairs) = *TOTEM_OBJECT_VALUE(gc, i);
+            totemRegister_InitList(TOTEM_OBJECT_KEY(gc, i), 2);
+        }
+        
+        totemObjectKey lookupKey;
+        totemObjectKey_Init(&lookupKey, TOTEM_OBJECT_KEY(gc, numPairs));
+        
+        if (!totemHashMap_InsertPrecomputedWithoutSearch(lookup, &lookupKey, sizeof(lookupKey), numPairs, totemObject_GetKeyHash(TOTEM_OBJECT_KEY(gc, numPairs))))
+        {
+            // pairs compacted so far stay put, a small object doesn't mind the gaps
+            totemHashMap_Cleanup(lookup);
+            totemExecState_Free(state, lookup, sizeof(totemHashMap));
+            return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        }
+        
+        numPairs++;
+    }
+    
+    obj->NumPairs = numPairs;
+    obj->Lookup = lookup;
+    state->GCNumBytes += sizeof(totemHashMap) + (sizeof(totemHashMapEntry) * numPairs);
+    return totemExecStatus_Continue;
+}
+
+static totemExecStatus totemExecState_ObjectAddKey(totemExecState *state, totemGCObject *gc, totemRegister *key, size_t *pairOut)
+{
+    totemObject *obj = gc->Object;
+    
+    if (!obj->Lookup && obj->NumKeys >= TOTEM_EXEC_SMALLOBJECTKEYS)
+    {
+        TOTEM_EXEC_CHECKRETURN(totemExecState_PromoteObject(state, gc));
+    }
+    
+    // reuse a pair left behind by a removed key if there is one
+    size_t pair = obj->NumPairs;
+    if (obj->Lookup)
+    {
+        totemHashValue freePair = 0;
+        if (totemHashMap_PeekFreeValue(obj->Lookup, &freePair))
+        {
+            pair = (size_t)freePair;
+        }
+    }
+    else if (obj->NumKeys < obj->NumPairs)
+    {
+        for (size_t i = 0; i < obj->NumPairs; i++)
+        {
+            if (totemRegister_IsNull(TOTEM_OBJECT_KEY(gc, i)))
             {
-                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+                pair = i;
+                break;
             }
         }
+    }
+    
+    if (pair == obj->NumPairs && (pair * 2) + 2 > gc->NumRegisters)
+    {
+        if (!totemExecState_ExpandGCObject(state, gc))
+        {
+            return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        }
+    }
+    
+    if (obj->Lookup)
+    {
+        totemObjectKey lookupKey;
+        totemObjectKey_Init(&lookupKey, key);
         
-        if (!totemHashMap_InsertPrecomputedWithoutSearch(obj->Object, &actualKey, sizeof(actualKey), registerIndex, hash))
+        if (!totemHashMap_InsertPrecomputedWithoutSearch(obj->Lookup, &lookupKey, sizeof(lookupKey), pair, totemObject_GetKeyHash(key)))
         {
             return totemExecStatus_Break(totemExecStatus_OutOfMemory);
         }
         
-        if (expanded)
+        state->GCNumBytes += sizeof(totemHashMapEntry);
+    }
+    
+    if (pair == obj->NumPairs)
+    {
+        obj->NumPairs++;
+    }
+    
+    // keys are ints or strings, so there's nothing to reference count
+    *TOTEM_OBJECT_KEY(gc, pair) = *key;
+    obj->NumKeys++;
+    *pairOut = pair;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_ObjectShift(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *dst)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(obj))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
+    
+    totemRegister actualKey;
+    TOTEM_EXEC_CHECKRETURN(totemExecState_ToObjectKey(state, key, &actualKey));
+    
+    size_t pair = 0;
+    if (!totemObject_FindPair(obj, &actualKey, &pair))
+    {
+        totemExecState_AssignNull(state, dst);
+        return totemExecStatus_Continue;
+    }
+    
+    if (obj->Object->Lookup)
+    {
+        totemObjectKey lookupKey;
+        totemObjectKey_Init(&lookupKey, &actualKey);
+        totemHashMap_RemovePrecomputed(obj->Object->Lookup, &lookupKey, sizeof(lookupKey), totemObject_GetKeyHash(&actualKey));
+        state->GCNumBytes -= sizeof(totemHashMapEntry);
+    }
+    
+    totemRegister *value = TOTEM_OBJECT_VALUE(obj, pair);
+    totemExecState_Assign(state, dst, value);
+    totemExecState_AssignNull(state, value);
+    totemRegister_InitList(TOTEM_OBJECT_KEY(obj, pair), 1);
+    obj->Object->NumKeys--;
+    
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_Next(totemExecState *state, totemRegister *src, totemRegister *cursor, totemRegister *key, totemRegister *value, totemBool *foundOut)
+{
+    size_t pos = (size_t)totemRegister_GetInt(cursor);
+    *foundOut = totemBool_False;
+    
+    if (totemRegister_IsArray(src))
+    {
+        totemGCObject *gc = totemRegister_GetGCObject(src);
+        if (pos >= gc->NumRegisters)
+        {
+            return totemExecStatus_Continue;
+        }
+        
+        totemExecState_AssignNewInt(state, key, (totemInt)pos);
+        totemExecState_Assign(state, value, &gc->Registers[pos]);
+    }
+    else if (totemRegister_IsTypedArray(src))
+    {
+        totemTypedArray *arr = totemRegister_GetGCObject(src)->TypedArray;
+        if (pos >= arr->Length)
+        {
+            return totemExecStatus_Continue;
+        }
+        
+        totemExecState_AssignNewInt(state, key, (totemInt)pos);
+        TOTEM_EXEC_CHECKRETURN(totemExecState_TypedArrayGet(state, arr, (totemInt)pos, value));
+    }
+    else if (totemRegister_IsObject(src))
+    {
+        // walk the pairs themselves, skipping gaps left by removed keys, so there's no hashing at all
+        totemGCObject *gc = totemRegister_GetGCObject(src);
+        while (pos < gc->Object->NumPairs && totemRegister_IsNull(TOTEM_OBJECT_KEY(gc, pos)))
+        {
+            pos++;
+        }
+        
+        if (pos >= gc->Object->NumPairs)
         {
-            state->GCNumBytes += sizeof(totemRegister) + sizeof(totemHashMapEntry);
+            return totemExecStatus_Continue;
         }
+        
+        totemExecState_Assign(state, key, TOTEM_OBJECT_KEY(gc, pos));
+        totemExecState_Assign(state, value, TOTEM_OBJECT_VALUE(gc, pos));
+    }
+    else
+    {
+        return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
     }
     
-    totemRegister *newReg = obj->Registers + registerIndex;
-    totemExecState_Assign(state, newReg, src);
+    totemExecState_AssignNewInt(state, cursor, (totemInt)(pos + 1));
+    *foundOut = totemBool_True;
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_ObjectGet(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *dst)
+{
+    totemRegister actualKey;
+    TOTEM_EXEC_CHECKRETURN(totemExecState_ToObjectKey(state, key, &actualKey));
+    
+    size_t pair = 0;
+    if (!totemObject_FindPair(obj, &actualKey, &pair))
+    {
+        totemExecState_AssignNull(state, dst);
+    }
+    else
+    {
+        totemExecState_Assign(state, dst, TOTEM_OBJECT_VALUE(obj, pair));
+    }
+    
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_ObjectSet(totemExecState *state, totemGCObject *obj, totemRegister *key, totemRegister *src)
+{
+    if (TOTEM_GCOBJECT_ISFROZEN(obj))
+    {
+        return totemExecStatus_Break(totemExecStatus_FrozenValueModified);
+    }
+    
+    totemRegister actualKey;
+    TOTEM_EXEC_CHECKRETURN(totemExecState_ToObjectKey(state, key, &actualKey));
+    
+    size_t pair = 0;
+    if (!totemObject_FindPair(obj, &actualKey, &pair))
+    {
+        TOTEM_EXEC_CHECKRETURN(totemExecState_ObjectAddKey(state, obj, &actualKey, &pair));
+    }
+    
+    totemExecState_Assign(state, TOTEM_OBJECT_VALUE(obj, pair), src);
+    return totemExecStatus_Continue;
+}
+
+totemBool totemObject_BuildLookup(totemGCObject *gc, totemHashMap *lookup)
+{
+    for (size_t i = 0; i < gc->Object->NumPairs; i++)
+    {
+        totemRegister *key = TOTEM_OBJECT_KEY(gc, i);
+        
+        totemObjectKey lookupKey;
+        totemObjectKey_Init(&lookupKey, key);
+        
+        if (!totemHashMap_InsertPrecomputedWithoutSearch(lookup, &lookupKey, sizeof(lookupKey), i, totemObject_GetKeyHash(key)))
+        {
+            return totemBool_False;
+        }
+    }
+    
+    return totemBool_True;
+}
+
+totemExecStatus totemExecState_CloneObject(totemExecState *state, totemGCObject *src, totemGCObject **gcOut)
+{
+    totemGCObject *gc = NULL;
+    TOTEM_EXEC_CHECKRETURN(totemExecState_CreateObject(state, (totemInt)src->Object->NumKeys, &gc));
+    
+    // keys are already flattened & unique, so copy the pairs straight across, closing any gaps
+    size_t numPairs = 0;
+    for (size_t i = 0; i < src->Object->NumPairs; i++)
+    {
+        totemRegister *key = TOTEM_OBJECT_KEY(src, i);
+        if (totemRegister_IsNull(key))
+        {
+            continue;
+        }
+        
+        *TOTEM_OBJECT_KEY(gc, numPairs) = *key;
+        totemExecState_Assign(state, TOTEM_OBJECT_VALUE(gc, numPairs), TOTEM_OBJECT_VALUE(src, i));
+        numPairs++;
+    }
+    
+    gc->Object->NumPairs = numPairs;
+    gc->Object->NumKeys = numPairs;
+    
+    if (numPairs > TOTEM_EXEC_SMALLOBJECTKEYS)
+    {
+        TOTEM_EXEC_CHECKRETURN(totemExecState_PromoteObject(state, gc));
+    }
+    
+    *gcOut = gc;
     return totemExecStatus_Continue;
 }
 
@@ -448,6 +1000,15 @@ totemExecStatus totemExecState_Cast(totemExecState *state, totemRegister *dst, t
         return totemExecStatus_Break(totemExecStatus_UnexpectedDataType);
     }
     
+    // string conversions expect nul-terminated values
+    totemRegister flattened;
+    if (totemRegister_IsRope(src))
+    {
+        totemRegister_SetNull(&flattened);
+        TOTEM_EXEC_CHECKRETURN(totemExecState_FlattenString(state, src, &flattened));
+        src = &flattened;
+    }
+    
     totemPublicDataType srcType = totemPrivateDataType_ToPublic(totemRegister_GetType(src));
     totemPublicDataType toType = totemRegister_GetTypeValue(typeReg);
     
@@ -462,12 +1023,21 @@ totemExecStatus totemExecState_Cast(totemExecState *state, totemRegister *dst, t
     {
         switch (srcType)
         {
-                // clone array
+                // copy array on first write, typed arrays come back boxed
             case totemPublicDataType_Array:
             {
                 totemGCObject *gc = NULL;
                 totemGCObject *arr = totemRegister_GetGCObject(src);
-                TOTEM_EXEC_CHECKRETURN(totemExecState_CreateArrayFromExisting(state, arr->Registers, arr->NumRegisters, &gc));
+                
+                if (totemRegister_IsTypedArray(src))
+                {
+                    TOTEM_EXEC_CHECKRETURN(totemExecState_TypedArrayToArray(state, arr->TypedArray, &gc));
+                }
+                else
+                {
+                    TOTEM_EXEC_CHECKRETURN(totemExecState_ShareArray(state, arr, 0, arr->NumRegisters, &gc));
+                }
+                
                 totemExecState_AssignNewArray(state, dst, gc);
                 break;
             }
@@ -560,7 +1130,8 @@ totemExecStatus totemExecState_Cast(totemExecState *state, totemRegister *dst, t
             case TOTEM_PUBLIC_TYPEPAIR(totemPublicDataType_Array, totemPublicDataType_Int):
             {
                 totemGCObject *arr = totemRegister_GetGCObject(src);
-                totemExecState_AssignNewInt(state, dst, (totemInt)arr->NumRegisters);
+                size_t length = totemRegister_IsTypedArray(src) ? arr->TypedArray->Length : arr->NumRegisters;
+                totemExecState_AssignNewInt(state, dst, (totemInt)length);
                 break;
             }
                 
@@ -568,17 +1139,15 @@ totemExecStatus totemExecState_Cast(totemExecState *state, totemRegister *dst, t
             case TOTEM_PUBLIC_TYPEPAIR(totemPublicDataType_Array, totemPublicDataType_Float):
             {
                 totemGCObject *arr = totemRegister_GetGCObject(src);
-                totemExecState_AssignNewFloat(state, dst, (totemFloat)arr->NumRegisters);
+                size_t length = totemRegister_IsTypedArray(src) ? arr->TypedArray->Length : arr->NumRegisters;
+                totemExecState_AssignNewFloat(state, dst, (totemFloat)length);
                 break;
             }
                 
                 // array as string (implode)
             case TOTEM_PUBLIC_TYPEPAIR(totemPublicDataType_Array, totemPublicDataType_String):
-            {
-                totemGCObject *arr = totemRegister_GetGCObject(src);
-                TOTEM_EXEC_CHECKRETURN(totemExecState_ArrayToString(state, arr->Registers, arr->NumRegisters, dst));
+                TOTEM_EXEC_CHECKRETURN(totemExecState_ToString(state, src, dst));
                 break;
-            }
                 
                 /*
                  * types
@@ -742,6 +1311,197 @@ totemExecStatus totemExecState_Cast(totemExecState *state, totemRegister *dst, t
     return totemExecStatus_Continue;
 }
 
+static totemExecStatus totemExecState_ConcatRope(totemExecState *state, totemRegister *str1, totemStringLength len1, totemRegister *str2, totemStringLength len2, totemRegister *strOut)
+{
+    totemStringLength len = len1 + len2;
+    totemRopeBuffer *buffer = NULL;
+    size_t offset = 0;
+    
+    // only a rope ending at the tip of its buffer may extend it, anything else would overwrite bytes another rope can see
+    if (totemRegister_IsRope(str1))
+    {
+        totemRope *rope = totemRegister_GetGCObject(str1)->Rope;
+        if (rope->Buffer && rope->Buffer->Length == rope->Offset + rope->Length)
+        {
+            buffer = rope->Buffer;
+            offset = rope->Offset;
+        }
+    }
+    
+    if (buffer)
+    {
+        if (buffer->Capacity < offset + len)
+        {
+            size_t newCapacity = buffer->Capacity * 2;
+            if (newCapacity < offset + len)
+            {
+                newCapacity = offset + len;
+            }
+            
+            char *newData = totemExecState_Alloc(state, newCapacity);
+            if (!newData)
+            {
+                return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+            }
+            
+            memcpy(newData, buffer->Data, buffer->Length);
+            totemExecState_Free(state, buffer->Data, buffer->Capacity);
+            
+            state->GCNumBytes += newCapacity - buffer->Capacity;
+            buffer->Data = newData;
+            buffer->Capacity = newCapacity;
+        }
+    }
+    else
+    {
+        buffer = totemExecState_Alloc(state, sizeof(totemRopeBuffer));
+        if (!buffer)
+        {
+            return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        }
+        
+        // leave room to grow, the next concatenation will most likely append to this one
+        buffer->Capacity = len * 2;
+        buffer->Data = totemExecState_Alloc(state, buffer->Capacity);
+        if (!buffer->Data)
+        {
+            totemExecState_Free(state, buffer, sizeof(totemRopeBuffer));
+            return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+        }
+        
+        totemRuntimeStringValue str1Val;
+        totemRegister_GetStringValue(str1, &str1Val);
+        memcpy(buffer->Data, str1Val.Value, len1);
+        
+        buffer->Length = len1;
+        buffer->NumRopes = 0;
+        state->GCNumBytes += sizeof(totemRopeBuffer) + buffer->Capacity;
+    }
+    
+    // str2 may view this same buffer, so only read it once the buffer has stopped moving
+    totemRuntimeStringValue str2Val;
+    totemRegister_GetStringValue(str2, &str2Val);
+    memcpy(buffer->Data + offset + len1, str2Val.Value, len2);
+    buffer->Length = offset + len;
+    
+    totemGCObject *gc = NULL;
+    totemExecStatus status = totemExecState_CreateRope(state, buffer, NULL, offset, len, &gc);
+    if (status != totemExecStatus_Continue)
+    {
+        if (!buffer->NumRopes)
+        {
+            state->GCNumBytes -= sizeof(totemRopeBuffer) + buffer->Capacity;
+            totemExecState_Free(state, buffer->Data, buffer->Capacity);
+            totemExecState_Free(state, buffer, sizeof(totemRopeBuffer));
+        }
+        
+        return status;
+    }
+    
+    totemExecState_AssignNewRope(state, strOut, gc);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_FlattenString(totemExecState *state, totemRegister *src, totemRegister *dst)
+{
+    if (!totemRegister_IsRope(src))
+    {
+        if (src != dst)
+        {
+            memcpy(dst, src, sizeof(totemRegister));
+        }
+        
+        return totemExecStatus_Continue;
+    }
+    
+    totemRope *rope = totemRegister_GetGCObject(src)->Rope;
+    
+    if (!rope->Flattened)
+    {
+        totemString toIntern;
+        toIntern.Value = totemRope_GetData(rope);
+        toIntern.Length = rope->Length;
+        
+        totemRegister interned;
+        totemRegister_SetNull(&interned);
+        TOTEM_EXEC_CHECKRETURN(totemExecState_InternString(state, &toIntern, &interned));
+        
+        if (!totemRegister_IsInternedString(&interned))
+        {
+            totemExecState_Assign(state, dst, &interned);
+            return totemExecStatus_Continue;
+        }
+        
+        rope->Flattened = totemRegister_GetInternedString(&interned);
+    }
+    
+    totemRuntimeStringValue val;
+    val.Type = totemPrivateDataType_InternedString;
+    val.InternedString = rope->Flattened;
+    totemExecState_AssignNewString(state, dst, &val);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_SliceString(totemExecState *state, totemRegister *src, totemInt start, totemInt length, totemRegister *strOut)
+{
+    totemStringLength len = totemRegister_GetStringLength(src);
+    
+    if (start < 0 || length < 0 || start > (totemInt)len || length > (totemInt)len - start)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    if (start == 0 && length == (totemInt)len)
+    {
+        totemExecState_Assign(state, strOut, src);
+        return totemExecStatus_Continue;
+    }
+    
+    totemRuntimeStringValue val;
+    totemRegister_GetStringValue(src, &val);
+    
+    // short enough to fit in the register itself
+    if (length <= TOTEM_MINISTRING_MAXLENGTH)
+    {
+        totemString toIntern;
+        toIntern.Value = val.Value + start;
+        toIntern.Length = (totemStringLength)length;
+        
+        return totemExecState_InternString(state, &toIntern, strOut);
+    }
+    
+    totemGCObject *gc = NULL;
+    
+    if (totemRegister_IsRope(src))
+    {
+        totemRope *rope = totemRegister_GetGCObject(src)->Rope;
+        TOTEM_EXEC_CHECKRETURN(totemExecState_CreateRope(state, rope->Buffer, rope->Source, rope->Offset + (size_t)start, (totemStringLength)length, &gc));
+    }
+    else
+    {
+        TOTEM_EXEC_CHECKRETURN(totemExecState_CreateRope(state, NULL, totemRegister_GetInternedString(src), (size_t)start, (totemStringLength)length, &gc));
+    }
+    
+    totemExecState_AssignNewRope(state, strOut, gc);
+    return totemExecStatus_Continue;
+}
+
+totemExecStatus totemExecState_StringByte(totemExecState *state, totemRegister *src, totemInt index, totemRegister *dst)
+{
+    totemStringLength len = totemRegister_GetStringLength(src);
+    
+    if (index < 0 || index >= (totemInt)len)
+    {
+        return totemExecStatus_Break(totemExecStatus_IndexOutOfBounds);
+    }
+    
+    totemRuntimeStringValue val;
+    totemRegister_GetStringValue(src, &val);
+    
+    totemExecState_AssignNewInt(state, dst, (unsigned char)val.Value[index]);
+    return totemExecStatus_Continue;
+}
+
 totemExecStatus totemExecState_ConcatStrings(totemExecState *state, totemRegister *str1, totemRegister *str2, totemRegister *strOut)
 {
     totemStringLength len1 = totemRegister_GetStringLength(str1);
@@ -765,6 +1525,11 @@ totemExecStatus totemExecState_ConcatStrings(totemExecState *state, totemRegiste
         return totemExecStatus_Continue;
     }
     
+    if (len1 + len2 > TOTEM_EXEC_ROPETHRESHOLD)
+    {
+        return totemExecState_ConcatRope(state, str1, len1, str2, len2, strOut);
+    }
+    
     char *buffer = totemExecState_Alloc(state, len1 + len2);
     if (!buffer)
     {
@@ -779,7 +1544,7 @@ totemExecStatus totemExecState_ConcatStrings(totemExecState *state, totemRegiste
     toIntern.Length = len1 + len2;
     
     totemExecStatus status = totemExecState_InternString(state, &toIntern, strOut);
-    totem_CacheFree(buffer, len1 + len2);
+    totemExecState_Free(state, buffer, len1 + len2);
     return status;
 }
 
@@ -799,11 +1564,15 @@ totemExecStatus totemExecState_ToString(totemExecState *state, totemRegister *sr
             return totemExecState_ArrayToString(state, gc->Registers, gc->NumRegisters, dst);
         }
             
+        case totemPrivateDataType_TypedArray:
+            return totemExecState_TypedArrayToString(state, totemRegister_GetGCObject(src)->TypedArray, dst);
+            
         case totemPrivateDataType_Float:
             return totemExecState_FloatToString(state, totemRegister_GetFloat(src), dst);
             
         case totemPrivateDataType_InternedString:
         case totemPrivateDataType_MiniString:
+        case totemPrivateDataType_Rope:
             memcpy(dst, src, sizeof(totemRegister));
             return totemExecStatus_Continue;
             
@@ -835,16 +1604,10 @@ totemExecStatus totemExecState_EmptyString(totemExecState *state, totemRegister
 
 totemExecStatus totemExecState_IntToString(totemExecState *state, totemInt val, totemRegister *strOut)
 {
-    char buffer[256];
-    int result = totem_snprintf(buffer, TOTEM_ARRAY_SIZE(buffer), "%"TOTEM_INT_PRINTF, val);
-    
-    if (result < 0 || result >= TOTEM_ARRAY_SIZE(buffer))
-    {
-        return totemExecStatus_Break(totemExecStatus_InternalBufferOverrun);
-    }
+    char buffer[TOTEM_INTCHARS_MAXLENGTH];
     
     totemString string;
-    string.Length = result;
+    string.Length = totem_IntToChars(buffer, val);
     string.Value = buffer;
     
     return totemExecState_InternString(state, &string, strOut);
@@ -852,15 +1615,10 @@ totemExecStatus totemExecState_IntToString(totemExecState *state, totemInt val,
 
 totemExecStatus totemExecState_FloatToString(totemExecState *state, totemFloat val, totemRegister *strOut)
 {
-    char buffer[256];
-    int result = totem_snprintf(buffer, TOTEM_ARRAY_SIZE(buffer), "%.6g", val);
-    if (result < 0 || result >= TOTEM_ARRAY_SIZE(buffer))
-    {
-        return totemExecStatus_Break(totemExecStatus_InternalBufferOverrun);
-    }
+    char buffer[TOTEM_FLOATCHARS_MAXLENGTH];
     
     totemString string;
-    string.Length = result;
+    string.Length = totem_FloatToChars(buffer, val);
     string.Value = buffer;
     
     return totemExecState_InternString(state, &string, strOut);
@@ -969,7 +1727,7 @@ totemExecStatus totemExecState_ArrayToString(totemExecState *state, totemRegiste
         
         if (status != totemExecStatus_Continue)
         {
-            totem_CacheFree(strings, sizeof(totemRegister) * numRegisters);
+            totemExecState_Free(state, strings, sizeof(totemRegister) * numRegisters);
             return totemExecStatus_Break(totemExecStatus_UnrecognisedOperation);
         }
         
@@ -978,14 +1736,14 @@ totemExecStatus totemExecState_ArrayToString(totemExecState *state, totemRegiste
     
     if (!totalLen)
     {
-        totem_CacheFree(strings, sizeof(totemRegister) * numRegisters);
+        totemExecState_Free(state, strings, sizeof(totemRegister) * numRegisters);
         return totemExecState_EmptyString(state, strOut);
     }
     
     char *buffer = totemExecState_Alloc(state, totalLen + 1);
     if (!buffer)
     {
-        totem_CacheFree(strings, sizeof(totemRegister) * numRegisters);
+        totemExecState_Free(state, strings, sizeof(totemRegister) * numRegisters);
         return totemExecStatus_Break(totemExecStatus_OutOfMemory);
     }
     
@@ -1001,15 +1759,65 @@ totemExecStatus totemExecState_ArrayToString(totemExecState *state, totemRegiste
         current += len;
     }
     
-    totem_CacheFree(strings, sizeof(totemRegister) * numRegisters);
+    totemExecState_Free(state, strings, sizeof(totemRegister) * numRegisters);
     
     totemString toIntern;
     toIntern.Value = buffer;
     toIntern.Length = totalLen;
     
     status = totemExecState_InternString(state, &toIntern, strOut);
-    totem_CacheFree(buffer, totalLen + 1);
+    totemExecState_Free(state, buffer, totalLen + 1);
+    
+    return status;
+}
+
+// formats straight from the elements, there are no registers to convert one by one
+totemExecStatus totemExecState_TypedArrayToString(totemExecState *state, totemTypedArray *arr, totemRegister *strOut)
+{
+    if (arr->Length == 0)
+    {
+        return totemExecState_EmptyString(state, strOut);
+    }
+    
+    size_t maxLength = arr->Length * (arr->Type == totemTypedArrayType_Float64 ? TOTEM_FLOATCHARS_MAXLENGTH : TOTEM_INTCHARS_MAXLENGTH);
+    char *buffer = totemExecState_Alloc(state, maxLength);
+    if (!buffer)
+    {
+        return totemExecStatus_Break(totemExecStatus_OutOfMemory);
+    }
     
+    size_t len = 0;
+    for (size_t i = 0; i < arr->Length; i++)
+    {
+        switch (arr->Type)
+        {
+            case totemTypedArrayType_Float64:
+                len += totem_FloatToChars(buffer + len, ((double*)arr->Data)[i]);
+                break;
+            
+            case totemTypedArrayType_Int32:
+                len += totem_IntToChars(buffer + len, ((int32_t*)arr->Data)[i]);
+                break;
+            
+            case totemTypedArrayType_Int64:
+                len += totem_IntToChars(buffer + len, ((int64_t*)arr->Data)[i]);
+                break;
+            
+            case totemTypedArrayType_Uint8:
+                len += totem_IntToChars(buffer + len, ((uint8_t*)arr->Data)[i]);
+                break;
+            
+            default:
+                break;
+        }
+    }
+    
+    totemString toIntern;
+    toIntern.Value = buffer;
+    toIntern.Length = len;
+    
+    totemExecStatus status = totemExecState_InternString(state, &toIntern, strOut);
+    totemExecState_Free(state, buffer, maxLength);
     return status;
 }
 
@@ -1019,6 +1827,15 @@ totemExecStatus totemExecState_ConcatArrays(totemExecState *state, totemRegister
     totemGCObject *src1Gc = totemRegister_GetGCObject(src1);
     totemGCObject *src2Gc = totemRegister_GetGCObject(src2);
     
+    // joining onto nothing is just the other array, which can be shared until written to
+    if (!src1Gc->NumRegisters || !src2Gc->NumRegisters)
+    {
+        totemGCObject *src = src1Gc->NumRegisters ? src1Gc : src2Gc;
+        TOTEM_EXEC_CHECKRETURN(totemExecState_ShareArray(state, src, 0, src->NumRegisters, &gc));
+        totemExecState_AssignNewArray(state, dst, gc);
+        return totemExecStatus_Continue;
+    }
+    
     TOTEM_EXEC_CHECKRETURN(totemExecState_CreateArray(state, src1Gc->NumRegisters + src2Gc->NumRegisters, &gc));
     
     totemRegister *newRegs = gc->Registers;
@@ -80,7 +80,7 @@
 
 #define TOTEM_VM_DEFINE_DISPATCH_TABLE() static const void *s_opcodes[UINT8_MAX + 1] = \
     { \
-        [29 ... 255] = &&TOTEM_VM_DISPATCH_DEFAULT_TARGET_LABEL, \
+        [31 ... 255] = &&TOTEM_VM_DISPATCH_DEFAULT_TARGET_LABEL, \
         TOTEM_EMIT_OPCODES() \
     }
 
@@ -324,6 +324,40 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
             TOTEM_VM_DISPATCH();
         }
         
+        TOTEM_VM_DISPATCH_TARGET(totemOperationType_Next)
+        {
+            // the word after holds the key register in A, & the offset from there to the end of the loop in Bx
+            totemRegister *a = TOTEM_VM_GET_A(base, ins);
+            totemRegister *b = TOTEM_VM_GET_B(base, ins);
+            totemRegister *c = TOTEM_VM_GET_C(base, ins);
+            totemInstruction ext = insPtr[1];
+            totemRegister *key = TOTEM_VM_GET_A(base, ext);
+            totemBool found = totemBool_False;
+            
+            TOTEM_VM_BREAK(totemExecState_Next(state, b, a, key, c, &found), state);
+            
+            if (found)
+            {
+                insPtr += 2;
+            }
+            else
+            {
+                insPtr += 1 + TOTEM_INSTRUCTION_GET_BX_SIGNED(ext);
+            }
+            
+            TOTEM_VM_DISPATCH();
+        }
+        
+        TOTEM_VM_DISPATCH_TARGET(totemOperationType_CheckStruct)
+        {
+            // records are arrays with exactly one slot per field
+            totemRegister *a = TOTEM_VM_GET_A(base, ins);
+            totemOperandXUnsigned bx = TOTEM_INSTRUCTION_GET_BX_UNSIGNED(ins);
+            TOTEM_VM_ASSERT(totemRegister_IsArray(a) && totemRegister_GetGCObject(a)->NumRegisters == bx, state, totemExecStatus_UnexpectedDataType);
+            insPtr++;
+            TOTEM_VM_DISPATCH();
+        }
+        
         TOTEM_VM_DISPATCH_TARGET(totemOperationType_ConditionalGoto)
         {
             totemRegister *a = TOTEM_VM_GET_A(base, ins);
@@ -359,6 +393,13 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
             else
             {
                 totemExecState_Assign(state, call->ReturnRegister, TOTEM_VM_GET_A(base, ins));
+                
+                // calls made by native functions go back to them, which pop the call themselves
+                if (TOTEM_HASBITS(call->Flags, totemFunctionCallFlag_ReturnToNative))
+                {
+                    return;
+                }
+                
                 totemExecState_PopRoutine(state);
                 call = state->CallStack;
                 TOTEM_VM_RESET();
@@ -373,10 +414,23 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
         {
             totemRegister *a = TOTEM_VM_GET_A(base, ins);
             totemRegister *b = TOTEM_VM_GET_B(base, ins);
+            totemRegister *c = TOTEM_VM_GET_C(base, ins);
             totemGCObject *gc;
             
-            TOTEM_VM_ASSERT(totemRegister_IsInt(b), state, totemExecStatus_UnexpectedDataType);
-            TOTEM_VM_BREAK(totemExecState_CreateArray(state, totemRegister_GetInt(b), &gc), state);
+            // plain arrays pass their size as both B & C, so a separate C can only be a literal's template
+            if (c != b)
+            {
+                // constant elements come from the literal's template, shared until written to
+                TOTEM_VM_ASSERT(totemRegister_IsArray(c), state, totemExecStatus_UnexpectedDataType);
+                totemGCObject *templateGc = totemRegister_GetGCObject(c);
+                TOTEM_VM_BREAK(totemExecState_ShareArray(state, templateGc, 0, templateGc->NumRegisters, &gc), state);
+            }
+            else
+            {
+                TOTEM_VM_ASSERT(totemRegister_IsInt(b), state, totemExecStatus_UnexpectedDataType);
+                TOTEM_VM_BREAK(totemExecState_CreateArray(state, totemRegister_GetInt(b), &gc), state);
+            }
+            
             totemExecState_AssignNewArray(state, a, gc);
             insPtr++;
             TOTEM_VM_DISPATCH();
@@ -400,6 +454,23 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
                 TOTEM_VM_ASSERT(totemRegister_IsInt(c), state, totemExecStatus_InvalidKey);
                 TOTEM_VM_BREAK(totemExecState_ArrayGet(state, gc->Registers, gc->NumRegisters, totemRegister_GetInt(c), a), state);
             }
+            else if (totemRegister_IsTypedArray(b))
+            {
+                gc = totemRegister_GetGCObject(b);
+                TOTEM_VM_ASSERT(totemRegister_IsInt(c), state, totemExecStatus_InvalidKey);
+                
+                // bytes are the common case when parsing binary data, so skip the call & type switch for them
+                totemTypedArray *arr = gc->TypedArray;
+                totemInt index = totemRegister_GetInt(c);
+                if (arr->Type == totemTypedArrayType_Uint8 && index >= 0 && ((size_t)index) < arr->Length)
+                {
+                    totemExecState_AssignNewInt(state, a, ((uint8_t*)arr->Data)[index]);
+                }
+                else
+                {
+                    TOTEM_VM_BREAK(totemExecState_TypedArrayGet(state, arr, index, a), state);
+                }
+            }
             else if (totemRegister_IsObject(b))
             {
                 gc = totemRegister_GetGCObject(b);
@@ -425,8 +496,32 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
             {
                 gc = totemRegister_GetGCObject(a);
                 TOTEM_VM_ASSERT(totemRegister_IsInt(b), state, totemExecStatus_InvalidKey);
+                TOTEM_VM_ASSERT(!TOTEM_GCOBJECT_ISFROZEN(gc), state, totemExecStatus_FrozenValueModified);
+                
+                if (gc->ArrayStore)
+                {
+                    TOTEM_VM_BREAK(totemExecState_UnshareArray(state, gc), state);
+                }
+                
                 TOTEM_VM_BREAK(totemExecState_ArraySet(state, gc->Registers, gc->NumRegisters, totemRegister_GetInt(b), c), state);
             }
+            else if (totemRegister_IsTypedArray(a))
+            {
+                gc = totemRegister_GetGCObject(a);
+                TOTEM_VM_ASSERT(totemRegister_IsInt(b), state, totemExecStatus_InvalidKey);
+                TOTEM_VM_ASSERT(!TOTEM_GCOBJECT_ISFROZEN(gc), state, totemExecStatus_FrozenValueModified);
+                
+                totemTypedArray *arr = gc->TypedArray;
+                totemInt index = totemRegister_GetInt(b);
+                if (arr->Type == totemTypedArrayType_Uint8 && totemRegister_IsInt(c) && index >= 0 && ((size_t)index) < arr->Length)
+                {
+                    ((uint8_t*)arr->Data)[index] = (uint8_t)totemRegister_GetInt(c);
+                }
+                else
+                {
+                    TOTEM_VM_BREAK(totemExecState_TypedArraySet(state, arr, index, c), state);
+                }
+            }
             else if (totemRegister_IsObject(a))
             {
                 gc = totemRegister_GetGCObject(a);
@@ -452,8 +547,22 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
             {
                 totemGCObject *gc = totemRegister_GetGCObject(b);
                 TOTEM_VM_ASSERT(totemRegister_IsInt(c), state, totemExecStatus_InvalidKey);
+                TOTEM_VM_ASSERT(!TOTEM_GCOBJECT_ISFROZEN(gc), state, totemExecStatus_FrozenValueModified);
+                
+                if (gc->ArrayStore)
+                {
+                    TOTEM_VM_BREAK(totemExecState_UnshareArray(state, gc), state);
+                }
+                
                 TOTEM_VM_BREAK(totemExecState_ArrayShift(state, gc->Registers, gc->NumRegisters, totemRegister_GetInt(c), a), state);
             }
+            else if (totemRegister_IsTypedArray(b))
+            {
+                totemGCObject *gc = totemRegister_GetGCObject(b);
+                TOTEM_VM_ASSERT(totemRegister_IsInt(c), state, totemExecStatus_InvalidKey);
+                TOTEM_VM_ASSERT(!TOTEM_GCOBJECT_ISFROZEN(gc), state, totemExecStatus_FrozenValueModified);
+                TOTEM_VM_BREAK(totemExecState_TypedArrayShift(state, gc->TypedArray, totemRegister_GetInt(c), a), state);
+            }
             else if (totemRegister_IsObject(b))
             {
                 TOTEM_VM_BREAK(totemExecState_ObjectShift(state, totemRegister_GetGCObject(b), c, a), state);
@@ -588,6 +697,12 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
             switch (call->Type)
             {
                 case totemFunctionType_Native:
+                    // natives expect strings to be interned & nul-terminated
+                    for (size_t i = 0; i < call->NumArguments; i++)
+                    {
+                        TOTEM_VM_BREAK(totemExecState_FlattenString(state, &call->FrameStart[i], &call->FrameStart[i]), state);
+                    }
+                    
                     TOTEM_VM_BREAK(call->NativeFunction->Callback(state), state);
                     totemExecState_PopRoutine(state);
                     call = state->CallStack;
@@ -606,11 +721,22 @@ void totemExecState_ExecuteInstructions(totemExecState *state)
         {
             totemRegister *a = TOTEM_VM_GET_A(base, ins);
             totemRegister *b = TOTEM_VM_GET_B(base, ins);
+            totemRegister *c = TOTEM_VM_GET_C(base, ins);
             totemGCObject *gc;
             
-            TOTEM_VM_ASSERT(totemRegister_IsInt(b), state, totemExecStatus_UnexpectedDataType);
+            // as with arrays, a C separate from B is the literal's template
+            if (c != b)
+            {
+                // constant keys & values come from the literal's template
+                TOTEM_VM_ASSERT(totemRegister_IsObject(c), state, totemExecStatus_UnexpectedDataType);
+                TOTEM_VM_BREAK(totemExecState_CloneObject(state, totemRegister_GetGCObject(c), &gc), state);
+            }
+            else
+            {
+                TOTEM_VM_ASSERT(totemRegister_IsInt(b), state, totemExecStatus_UnexpectedDataType);
+                TOTEM_VM_BREAK(totemExecState_CreateObject(state, totemRegister_GetInt(b), &gc), state);
+            }
             
-            TOTEM_VM_BREAK(totemExecState_CreateObject(state, totemRegister_GetInt(b), &gc), state);
             totemExecState_AssignNewObject(state, a, gc);
             insPtr++;
             TOTEM_VM_DISPATCH();
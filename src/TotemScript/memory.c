@@ -12,7 +12,12 @@
 
 #define TOTEM_MEM_FREELIST_DIVISOR (sizeof(totemMemoryPageObject))
 #define TOTEM_MEM_PAGESIZE (TOTEM_MEM_FREELIST_DIVISOR * 512)
-#define TOTEM_MEM_NUM_FREELISTS (TOTEM_MEM_PAGESIZE / TOTEM_MEM_FREELIST_DIVISOR)
+#define TOTEM_MEM_PAGEHEADERSIZE (TOTEM_MEM_FREELIST_DIVISOR * 8)
+#define TOTEM_MEM_MAXOBJECTSIZE (TOTEM_MEM_PAGESIZE - TOTEM_MEM_PAGEHEADERSIZE)
+#define TOTEM_MEM_NUM_FREELISTS (TOTEM_MEM_MAXOBJECTSIZE / TOTEM_MEM_FREELIST_DIVISOR)
+
+// number of completely free pages a size-class may hold on to before they are returned to the system
+#define TOTEM_MEM_MAXEMPTYPAGES (4)
 
 #if TOTEM_DEBUGOPT_ASSERT_HASHMAP_LISTS
 #define totemHashMap_Assert(x) totemHashMap_AssertList(x)
@@ -26,29 +31,132 @@ typedef struct totemMemoryPageObject
 }
 totemMemoryPageObject;
 
+// pages are TOTEM_MEM_PAGESIZE-aligned, so the owning page of any object can be found by masking its address
+// header sits at the front of the page, objects follow at TOTEM_MEM_PAGEHEADERSIZE
 typedef struct totemMemoryPage
 {
     struct totemMemoryPage *Next;
+    struct totemMemoryPage *Prev;
+    totemMemoryPageObject *HeadObject;
+    struct totemMemoryChunk *Chunk;
     size_t NumAllocated;
+    size_t NumLive;
     size_t NumTotal;
-    char Data[TOTEM_MEM_PAGESIZE];
 }
 totemMemoryPage;
 
+// pages are carved from larger chunks, so the system is only asked for memory a chunk at a time
+#define TOTEM_MEM_CHUNK_NUMPAGES (64)
+#define TOTEM_MEM_CHUNKSIZE (TOTEM_MEM_PAGESIZE * TOTEM_MEM_CHUNK_NUMPAGES)
+
+typedef struct totemMemoryChunk
+{
+    struct totemMemoryChunk *Next;
+    struct totemMemoryChunk *Prev;
+    char *Data;
+    void *Base;
+    uint64_t Used;
+    size_t NumUsed;
+}
+totemMemoryChunk;
+
+static totemLock s_ChunkLock;
+static totemMemoryChunk *s_Chunks = NULL;
+static totemMemoryChunk *s_FullChunks = NULL;
+
+// pages with free space are kept at the head of the list, full pages at the tail
 typedef struct
 {
     totemLock Lock;
     totemMemoryPage *HeadPage;
-    totemMemoryPageObject *HeadObject;
+    totemMemoryPage *TailPage;
+    size_t NumEmptyPages;
     size_t ObjectSize;
+    size_t NumPages;
+    size_t NumLive;
+    size_t PeakLive;
+    size_t NumContentions;
+#if TOTEM_MEMOPT_THREAD_CACHE
+    size_t MagazineSize;
+    
+    // objects counted as live that are actually sitting in a thread's magazine
+    size_t NumCached;
+#endif
 }
 totemMemoryFreeList;
 
 static totemMemoryFreeList s_FreeLists[TOTEM_MEM_NUM_FREELISTS];
 
+#if TOTEM_MEMOPT_THREAD_CACHE
+
+// upper bound on objects & bytes held by a single thread-local magazine
+#define TOTEM_MEM_MAGAZINE_MAXOBJECTS (64)
+#define TOTEM_MEM_MAGAZINE_MAXBYTES (TOTEM_MEM_PAGESIZE * 2)
+
+typedef struct
+{
+    totemMemoryPageObject *HeadObject;
+    size_t NumObjects;
+}
+totemMemoryMagazine;
+
+static TOTEM_THREADLOCAL totemMemoryMagazine s_Magazines[TOTEM_MEM_NUM_FREELISTS];
+
+// bumped on every init & cleanup - a thread whose magazines belong to an older generation drops them on next use
+static size_t s_MagazineGeneration = 0;
+static TOTEM_THREADLOCAL size_t s_ThreadMagazineGeneration = 0;
+
+// thread-exit hook that spills whatever the exiting thread still has cached
+#ifdef TOTEM_WIN
+static DWORD s_MagazineKey = FLS_OUT_OF_INDEXES;
+#else
+static pthread_key_t s_MagazineKey;
+#endif
+
+#endif
+
+#if TOTEM_MEMOPT_HUGEPAGES
+
+#define TOTEM_MEM_ARENASIZE (2 * 1024 * 1024)
+#define TOTEM_MEM_ARENA_NUMPAGES (TOTEM_MEM_ARENASIZE / TOTEM_MEM_PAGESIZE)
+#define TOTEM_MEM_ARENA_MINSIZE (TOTEM_MEM_PAGESIZE * 4)
+#define TOTEM_MEM_ARENA_MAXSIZE (TOTEM_MEM_ARENASIZE / 2)
+
+// 2MB-aligned chunk handed out in page-sized units, tracked by a bitmap
+typedef struct totemMemoryArena
+{
+    struct totemMemoryArena *Next;
+    char *Data;
+    size_t NumFree;
+    uint64_t Used[TOTEM_MEM_ARENA_NUMPAGES / 64];
+}
+totemMemoryArena;
+
+// allocations too big for an arena get a mapping of their own
+typedef struct totemMemoryHugeMap
+{
+    struct totemMemoryHugeMap *Next;
+    char *Data;
+    size_t Size;
+}
+totemMemoryHugeMap;
+
+static totemLock s_ArenaLock;
+static totemMemoryArena *s_Arenas = NULL;
+static totemMemoryHugeMap *s_HugeMaps = NULL;
+
+#endif
+
 static totemMallocCb mallocCb = NULL;
 static totemFreeCb freeCb = NULL;
 
+// allocations too big for the size-classes
+static totemLock s_LargeStatsLock;
+static size_t s_NumLargeAllocations = 0;
+static size_t s_NumLargeBytes = 0;
+static size_t s_PeakLargeBytes = 0;
+static size_t s_TotalLargeAllocations = 0;
+
 //size_t allocs = 0;
 
 void *totem_Malloc(size_t len)
@@ -59,160 +167,1155 @@ void *totem_Malloc(size_t len)
         return mallocCb(len);
     }
     
-    return malloc(len);
+    return malloc(len);
+}
+
+void totem_Free(void *mem)
+{
+    //printf("freeing %zu\n", --allocs);
+    if (freeCb)
+    {
+        freeCb(mem);
+    }
+    else
+    {
+        free(mem);
+    }
+}
+
+static void totemMemoryChunk_Release(totemMemoryChunk *chunk)
+{
+    if (chunk->Base)
+    {
+        totem_Free(chunk->Base);
+    }
+    else
+    {
+#ifdef TOTEM_WIN
+        _aligned_free(chunk->Data);
+#else
+        munmap(chunk->Data, TOTEM_MEM_CHUNKSIZE);
+#endif
+    }
+    
+    totem_Free(chunk);
+}
+
+// chunk lock must be held
+static void totemMemoryChunk_Unlink(totemMemoryChunk **list, totemMemoryChunk *chunk)
+{
+    if (chunk->Prev)
+    {
+        chunk->Prev->Next = chunk->Next;
+    }
+    else
+    {
+        *list = chunk->Next;
+    }
+    
+    if (chunk->Next)
+    {
+        chunk->Next->Prev = chunk->Prev;
+    }
+    
+    chunk->Next = NULL;
+    chunk->Prev = NULL;
+}
+
+// chunk lock must be held
+static void totemMemoryChunk_PushFront(totemMemoryChunk **list, totemMemoryChunk *chunk)
+{
+    chunk->Prev = NULL;
+    chunk->Next = *list;
+    
+    if (*list)
+    {
+        (*list)->Prev = chunk;
+    }
+    
+    *list = chunk;
+}
+
+// chunk lock must be held
+static totemMemoryChunk *totemMemoryChunk_Create()
+{
+    totemMemoryChunk *chunk = totem_Malloc(sizeof(totemMemoryChunk));
+    if (!chunk)
+    {
+        return NULL;
+    }
+    
+    chunk->Base = NULL;
+    chunk->Data = NULL;
+    
+    if (mallocCb)
+    {
+        // host allocator makes no alignment promises, over-allocate by a page and align ourselves
+        chunk->Base = mallocCb(TOTEM_MEM_CHUNKSIZE + TOTEM_MEM_PAGESIZE);
+        if (chunk->Base)
+        {
+            chunk->Data = (char*)(((uintptr_t)chunk->Base + TOTEM_MEM_PAGESIZE - 1) & ~(uintptr_t)(TOTEM_MEM_PAGESIZE - 1));
+        }
+    }
+    else
+    {
+#ifdef TOTEM_WIN
+        chunk->Data = _aligned_malloc(TOTEM_MEM_CHUNKSIZE, TOTEM_MEM_PAGESIZE);
+#else
+        chunk->Data = mmap(NULL, TOTEM_MEM_CHUNKSIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+        if (chunk->Data == MAP_FAILED)
+        {
+            chunk->Data = NULL;
+        }
+#endif
+    }
+    
+    if (!chunk->Data)
+    {
+        totem_Free(chunk);
+        return NULL;
+    }
+    
+    chunk->Used = 0;
+    chunk->NumUsed = 0;
+    totemMemoryChunk_PushFront(&s_Chunks, chunk);
+    return chunk;
+}
+
+static totemMemoryPage *totemMemoryPage_Alloc()
+{
+    totemMemoryPage *page = NULL;
+    
+    totemLock_Acquire(&s_ChunkLock);
+    
+    // chunks with free pages are kept apart from full ones, so the head always has room
+    totemMemoryChunk *chunk = s_Chunks;
+    if (!chunk)
+    {
+        chunk = totemMemoryChunk_Create();
+    }
+    
+    if (chunk)
+    {
+        size_t index = 0;
+        while ((chunk->Used >> index) & 1)
+        {
+            index++;
+        }
+        
+        chunk->Used |= ((uint64_t)1 << index);
+        chunk->NumUsed++;
+        
+        page = (totemMemoryPage*)(chunk->Data + (index * TOTEM_MEM_PAGESIZE));
+        page->Chunk = chunk;
+        
+        if (chunk->NumUsed == TOTEM_MEM_CHUNK_NUMPAGES)
+        {
+            totemMemoryChunk_Unlink(&s_Chunks, chunk);
+            totemMemoryChunk_PushFront(&s_FullChunks, chunk);
+        }
+    }
+    
+    totemLock_Release(&s_ChunkLock);
+    return page;
+}
+
+static void totemMemoryPage_Free(totemMemoryPage *page)
+{
+    totemMemoryChunk *chunk = page->Chunk;
+    size_t index = (size_t)((char*)page - chunk->Data) / TOTEM_MEM_PAGESIZE;
+    
+    totemLock_Acquire(&s_ChunkLock);
+    
+    if (chunk->NumUsed == TOTEM_MEM_CHUNK_NUMPAGES)
+    {
+        totemMemoryChunk_Unlink(&s_FullChunks, chunk);
+        totemMemoryChunk_PushFront(&s_Chunks, chunk);
+    }
+    
+    chunk->Used &= ~((uint64_t)1 << index);
+    chunk->NumUsed--;
+    
+    // hand completely unused chunks back, but keep one around to avoid map/unmap churn
+    if (chunk->NumUsed == 0 && (chunk->Prev || chunk->Next))
+    {
+        totemMemoryChunk_Unlink(&s_Chunks, chunk);
+        totemMemoryChunk_Release(chunk);
+    }
+#if defined(TOTEM_POSIX) && defined(MADV_DONTNEED)
+    else if (!chunk->Base)
+    {
+        // the rest of the chunk is still in use, just let the system reclaim this page's memory
+        madvise(page, TOTEM_MEM_PAGESIZE, MADV_DONTNEED);
+    }
+#endif
+    
+    totemLock_Release(&s_ChunkLock);
+}
+
+static inline TOTEM_INLINE totemMemoryPage *totemMemoryPage_FromObject(void *obj)
+{
+    return (totemMemoryPage*)((uintptr_t)obj & ~(uintptr_t)(TOTEM_MEM_PAGESIZE - 1));
+}
+
+static void totemMemoryFreeList_Unlink(totemMemoryFreeList *freeList, totemMemoryPage *page)
+{
+    if (page->Prev)
+    {
+        page->Prev->Next = page->Next;
+    }
+    else
+    {
+        freeList->HeadPage = page->Next;
+    }
+    
+    if (page->Next)
+    {
+        page->Next->Prev = page->Prev;
+    }
+    else
+    {
+        freeList->TailPage = page->Prev;
+    }
+    
+    page->Next = NULL;
+    page->Prev = NULL;
+}
+
+static void totemMemoryFreeList_PushFront(totemMemoryFreeList *freeList, totemMemoryPage *page)
+{
+    page->Prev = NULL;
+    page->Next = freeList->HeadPage;
+    
+    if (freeList->HeadPage)
+    {
+        freeList->HeadPage->Prev = page;
+    }
+    else
+    {
+        freeList->TailPage = page;
+    }
+    
+    freeList->HeadPage = page;
+}
+
+static void totemMemoryFreeList_PushBack(totemMemoryFreeList *freeList, totemMemoryPage *page)
+{
+    page->Next = NULL;
+    page->Prev = freeList->TailPage;
+    
+    if (freeList->TailPage)
+    {
+        freeList->TailPage->Next = page;
+    }
+    else
+    {
+        freeList->HeadPage = page;
+    }
+    
+    freeList->TailPage = page;
+}
+
+// freelist lock must be held
+static size_t totemMemoryFreeList_Trim(totemMemoryFreeList *freeList)
+{
+    size_t numReleased = 0;
+    
+    for (totemMemoryPage *page = freeList->HeadPage; page != NULL; /* nada */)
+    {
+        totemMemoryPage *next = page->Next;
+        
+        if (page->NumLive == 0)
+        {
+            totemMemoryFreeList_Unlink(freeList, page);
+            totemMemoryPage_Free(page);
+            freeList->NumPages--;
+            numReleased++;
+        }
+        
+        page = next;
+    }
+    
+    freeList->NumEmptyPages = 0;
+    return numReleased;
+}
+
+#if TOTEM_MEMOPT_THREAD_CACHE
+
+#ifdef TOTEM_WIN
+static void WINAPI totemMemoryMagazine_OnThreadExit(void *data)
+#else
+static void totemMemoryMagazine_OnThreadExit(void *data)
+#endif
+{
+    totem_FlushThreadCache();
+}
+
+static void totemMemoryMagazine_Attach()
+{
+    memset(&s_Magazines, 0, sizeof(s_Magazines));
+    s_ThreadMagazineGeneration = s_MagazineGeneration;
+    
+    // the exit hook only fires for threads that have set a value
+#ifdef TOTEM_WIN
+    FlsSetValue(s_MagazineKey, s_Magazines);
+#else
+    pthread_setspecific(s_MagazineKey, s_Magazines);
+#endif
+}
+
+static inline TOTEM_INLINE totemMemoryMagazine *totemMemoryMagazine_Get(totemMemoryFreeList *freeList)
+{
+    if (s_ThreadMagazineGeneration != s_MagazineGeneration)
+    {
+        totemMemoryMagazine_Attach();
+    }
+    
+    return &s_Magazines[freeList - s_FreeLists];
+}
+
+#endif
+
+void totem_InitMemory()
+{
+    TOTEM_STATIC_ASSERT(sizeof(totemMemoryPage) <= TOTEM_MEM_PAGEHEADERSIZE, "Memory page header too large");
+    TOTEM_STATIC_ASSERT(TOTEM_MEM_CHUNK_NUMPAGES <= sizeof(uint64_t) * 8, "Chunk page bitmap too small");
+    
+    totemLock_Init(&s_ChunkLock);
+    s_Chunks = NULL;
+    s_FullChunks = NULL;
+    
+    memset(&s_FreeLists, 0, sizeof(s_FreeLists));
+    for (size_t i = 0; i < TOTEM_MEM_NUM_FREELISTS; i++)
+    {
+        totemMemoryFreeList *freeList = &s_FreeLists[i];
+        totemLock_Init(&freeList->Lock);
+        freeList->ObjectSize = (i + 1) * sizeof(totemMemoryPageObject);
+        
+#if TOTEM_MEMOPT_THREAD_CACHE
+        freeList->MagazineSize = TOTEM_MEM_MAGAZINE_MAXBYTES / freeList->ObjectSize;
+        if (freeList->MagazineSize > TOTEM_MEM_MAGAZINE_MAXOBJECTS)
+        {
+            freeList->MagazineSize = TOTEM_MEM_MAGAZINE_MAXOBJECTS;
+        }
+#endif
+    }
+    
+#if TOTEM_MEMOPT_THREAD_CACHE
+    s_MagazineGeneration++;
+#ifdef TOTEM_WIN
+    s_MagazineKey = FlsAlloc(totemMemoryMagazine_OnThreadExit);
+#else
+    pthread_key_create(&s_MagazineKey, totemMemoryMagazine_OnThreadExit);
+#endif
+#endif
+    
+#if TOTEM_MEMOPT_HUGEPAGES
+    totemLock_Init(&s_ArenaLock);
+    s_Arenas = NULL;
+    s_HugeMaps = NULL;
+#endif
+    
+    totemLock_Init(&s_LargeStatsLock);
+    s_NumLargeAllocations = 0;
+    s_NumLargeBytes = 0;
+    s_PeakLargeBytes = 0;
+    s_TotalLargeAllocations = 0;
+    
+    mallocCb = NULL;
+    freeCb = NULL;
+}
+
+void totem_CleanupMemory()
+{
+#if TOTEM_MEMOPT_HUGEPAGES
+    for (totemMemoryArena *arena = s_Arenas; arena != NULL; /* nada */)
+    {
+        totemMemoryArena *next = arena->Next;
+        munmap(arena->Data, TOTEM_MEM_ARENASIZE);
+        totem_CacheFree(arena, sizeof(totemMemoryArena));
+        arena = next;
+    }
+    
+    s_Arenas = NULL;
+    
+    for (totemMemoryHugeMap *map = s_HugeMaps; map != NULL; /* nada */)
+    {
+        totemMemoryHugeMap *next = map->Next;
+        munmap(map->Data, map->Size);
+        totem_CacheFree(map, sizeof(totemMemoryHugeMap));
+        map = next;
+    }
+    
+    s_HugeMaps = NULL;
+    totemLock_Cleanup(&s_ArenaLock);
+#endif
+    
+    totem_FlushThreadCache();
+    
+#if TOTEM_MEMOPT_THREAD_CACHE
+    // magazines still held by other threads point into pages about to be released, make sure they're never spilled
+    s_MagazineGeneration++;
+#ifdef TOTEM_WIN
+    FlsFree(s_MagazineKey);
+    s_MagazineKey = FLS_OUT_OF_INDEXES;
+#else
+    pthread_key_delete(s_MagazineKey);
+#endif
+#endif
+    
+    for (size_t i = 0; i < TOTEM_MEM_NUM_FREELISTS; i++)
+    {
+        totemMemoryFreeList *freeList = &s_FreeLists[i];
+        freeList->HeadPage = NULL;
+        freeList->TailPage = NULL;
+        freeList->NumPages = 0;
+        totemLock_Cleanup(&freeList->Lock);
+    }
+    
+    // every page lives in a chunk, so releasing the chunks releases them all
+    totemMemoryChunk *lists[] = { s_Chunks, s_FullChunks };
+    for (size_t i = 0; i < TOTEM_ARRAY_SIZE(lists); i++)
+    {
+        for (totemMemoryChunk *chunk = lists[i]; chunk != NULL; /* nada */)
+        {
+            totemMemoryChunk *next = chunk->Next;
+            totemMemoryChunk_Release(chunk);
+            chunk = next;
+        }
+    }
+    
+    s_Chunks = NULL;
+    s_FullChunks = NULL;
+    totemLock_Cleanup(&s_ChunkLock);
+    totemLock_Cleanup(&s_LargeStatsLock);
+}
+
+void totem_SetMemoryCallbacks(totemMallocCb newMallocCb, totemFreeCb newFreeCb)
+{
+    mallocCb = newMallocCb;
+    freeCb = newFreeCb;
+}
+
+totemMemoryFreeList *totemMemoryFreeList_Get(size_t amount)
+{
+    if(amount > TOTEM_MEM_MAXOBJECTSIZE)
+    {
+        return NULL;
+    }
+    
+    if(amount < sizeof(totemMemoryPageObject))
+    {
+        amount = sizeof(totemMemoryPageObject);
+    }
+    
+    size_t index = amount / TOTEM_MEM_FREELIST_DIVISOR;
+    index += (amount % TOTEM_MEM_FREELIST_DIVISOR != 0);
+    index--;
+    
+    totemMemoryFreeList *list = &s_FreeLists[index];
+    
+    totem_assert(amount <= list->ObjectSize);
+    totem_assert(list == &s_FreeLists[0] ? 1 : amount > (list - 1)->ObjectSize);
+    
+    return list;
+}
+
+static void totemMemoryFreeList_Lock(totemMemoryFreeList *freeList)
+{
+    if (!totemLock_TryAcquire(&freeList->Lock))
+    {
+        totemLock_Acquire(&freeList->Lock);
+        freeList->NumContentions++;
+    }
+}
+
+static void totemMemory_TrackLarge(size_t amount, totemBool alloc)
+{
+    totemLock_Acquire(&s_LargeStatsLock);
+    
+    if (alloc)
+    {
+        s_NumLargeAllocations++;
+        s_TotalLargeAllocations++;
+        s_NumLargeBytes += amount;
+        
+        if (s_NumLargeBytes > s_PeakLargeBytes)
+        {
+            s_PeakLargeBytes = s_NumLargeBytes;
+        }
+    }
+    else
+    {
+        s_NumLargeAllocations--;
+        s_NumLargeBytes -= amount;
+    }
+    
+    totemLock_Release(&s_LargeStatsLock);
+}
+
+// freelist lock must be held
+static totemMemoryPageObject *totemMemoryFreeList_Pop(totemMemoryFreeList *freeList)
+{
+    totemMemoryPage *page = freeList->HeadPage;
+    
+    if (!page || page->NumLive == page->NumTotal)
+    {
+        // grab a new page & allocate from that
+        page = totemMemoryPage_Alloc();
+        if (!page)
+        {
+            return NULL;
+        }
+        
+        page->HeadObject = NULL;
+        page->NumAllocated = 0;
+        page->NumLive = 0;
+        page->NumTotal = TOTEM_MEM_MAXOBJECTSIZE / freeList->ObjectSize;
+        totemMemoryFreeList_PushFront(freeList, page);
+        freeList->NumEmptyPages++;
+        freeList->NumPages++;
+    }
+    
+    totemMemoryPageObject *obj = page->HeadObject;
+    
+    // check page freelist first, then carve a new object off the end
+    if (obj)
+    {
+        page->HeadObject = obj->Next;
+    }
+    else
+    {
+        obj = (totemMemoryPageObject*)((char*)page + TOTEM_MEM_PAGEHEADERSIZE + (page->NumAllocated * freeList->ObjectSize));
+        page->NumAllocated++;
+    }
+    
+    if (page->NumLive == 0)
+    {
+        freeList->NumEmptyPages--;
+    }
+    
+    page->NumLive++;
+    freeList->NumLive++;
+    
+    if (freeList->NumLive > freeList->PeakLive)
+    {
+        freeList->PeakLive = freeList->NumLive;
+    }
+    
+    if (page->NumLive == page->NumTotal && page != freeList->TailPage)
+    {
+        totemMemoryFreeList_Unlink(freeList, page);
+        totemMemoryFreeList_PushBack(freeList, page);
+    }
+    
+    return obj;
+}
+
+// freelist lock must be held
+static void totemMemoryFreeList_Push(totemMemoryFreeList *freeList, totemMemoryPageObject *obj)
+{
+    totemMemoryPage *page = totemMemoryPage_FromObject(obj);
+    totemBool wasFull = page->NumLive == page->NumTotal;
+    
+    totem_assert(page->NumLive > 0);
+    
+    obj->Next = page->HeadObject;
+    page->HeadObject = obj;
+    page->NumLive--;
+    freeList->NumLive--;
+    
+    if (page->NumLive == 0)
+    {
+        if (freeList->NumEmptyPages >= TOTEM_MEM_MAXEMPTYPAGES)
+        {
+            totemMemoryFreeList_Unlink(freeList, page);
+            totemMemoryPage_Free(page);
+            freeList->NumPages--;
+            return;
+        }
+        
+        freeList->NumEmptyPages++;
+    }
+    
+    if (wasFull && page != freeList->HeadPage)
+    {
+        totemMemoryFreeList_Unlink(freeList, page);
+        totemMemoryFreeList_PushFront(freeList, page);
+    }
+}
+
+#if TOTEM_MEMOPT_THREAD_CACHE
+
+static void totemMemoryMagazine_Refill(totemMemoryMagazine *magazine, totemMemoryFreeList *freeList)
+{
+    size_t batch = (freeList->MagazineSize + 1) / 2;
+    
+    totemMemoryFreeList_Lock(freeList);
+    
+    for (size_t i = 0; i < batch; i++)
+    {
+        totemMemoryPageObject *obj = totemMemoryFreeList_Pop(freeList);
+        if (!obj)
+        {
+            break;
+        }
+        
+        obj->Next = magazine->HeadObject;
+        magazine->HeadObject = obj;
+        magazine->NumObjects++;
+        freeList->NumCached++;
+    }
+    
+    totemLock_Release(&freeList->Lock);
+}
+
+static void totemMemoryMagazine_Spill(totemMemoryMagazine *magazine, totemMemoryFreeList *freeList, size_t amount)
+{
+    if (amount == 0 || magazine->HeadObject == NULL)
+    {
+        return;
+    }
+    
+    totemMemoryFreeList_Lock(freeList);
+    
+    while (amount > 0 && magazine->HeadObject)
+    {
+        totemMemoryPageObject *obj = magazine->HeadObject;
+        magazine->HeadObject = obj->Next;
+        magazine->NumObjects--;
+        freeList->NumCached--;
+        amount--;
+        
+        totemMemoryFreeList_Push(freeList, obj);
+    }
+    
+    totemLock_Release(&freeList->Lock);
+}
+
+#endif
+
+void totem_FlushThreadCache()
+{
+#if TOTEM_MEMOPT_THREAD_CACHE
+    if (s_ThreadMagazineGeneration != s_MagazineGeneration)
+    {
+        return;
+    }
+    
+    for (size_t i = 0; i < TOTEM_MEM_NUM_FREELISTS; i++)
+    {
+        totemMemoryMagazine *magazine = &s_Magazines[i];
+        totemMemoryMagazine_Spill(magazine, &s_FreeLists[i], magazine->NumObjects);
+    }
+#endif
+}
+
+size_t totem_TrimMemory()
+{
+    size_t numReleased = 0;
+    
+    totem_FlushThreadCache();
+    
+    for (size_t i = 0; i < TOTEM_MEM_NUM_FREELISTS; i++)
+    {
+        totemMemoryFreeList *freeList = &s_FreeLists[i];
+        
+        totemMemoryFreeList_Lock(freeList);
+        numReleased += totemMemoryFreeList_Trim(freeList);
+        totemLock_Release(&freeList->Lock);
+    }
+    
+    return numReleased * TOTEM_MEM_PAGESIZE;
+}
+
+void totem_GetMemoryStats(totemMemoryStats *stats)
+{
+    memset(stats, 0, sizeof(totemMemoryStats));
+    stats->PageSize = TOTEM_MEM_PAGESIZE;
+    stats->NumSizeClasses = TOTEM_MEM_NUM_FREELISTS;
+    
+    for (size_t i = 0; i < TOTEM_MEM_NUM_FREELISTS; i++)
+    {
+        totemMemoryFreeList *freeList = &s_FreeLists[i];
+        
+        totemLock_Acquire(&freeList->Lock);
+        stats->NumPages += freeList->NumPages;
+        totemLock_Release(&freeList->Lock);
+    }
+    
+    totemLock_Acquire(&s_LargeStatsLock);
+    stats->NumLargeAllocations = s_NumLargeAllocations;
+    stats->NumLargeBytes = s_NumLargeBytes;
+    stats->PeakLargeBytes = s_PeakLargeBytes;
+    stats->TotalLargeAllocations = s_TotalLargeAllocations;
+    totemLock_Release(&s_LargeStatsLock);
+}
+
+totemBool totem_GetSizeClassStats(size_t index, totemMemorySizeClassStats *stats)
+{
+    if (index >= TOTEM_MEM_NUM_FREELISTS)
+    {
+        return totemBool_False;
+    }
+    
+    totemMemoryFreeList *freeList = &s_FreeLists[index];
+    
+    totemLock_Acquire(&freeList->Lock);
+    stats->ObjectSize = freeList->ObjectSize;
+    stats->NumPages = freeList->NumPages;
+    stats->NumLiveObjects = freeList->NumLive;
+    stats->NumCachedObjects = 0;
+    stats->NumFreeObjects = (freeList->NumPages * (TOTEM_MEM_MAXOBJECTSIZE / freeList->ObjectSize)) - freeList->NumLive;
+    
+#if TOTEM_MEMOPT_THREAD_CACHE
+    stats->NumCachedObjects = freeList->NumCached;
+    stats->NumLiveObjects -= freeList->NumCached;
+#endif
+
+    stats->PeakLiveObjects = freeList->PeakLive;
+    stats->NumLockContentions = freeList->NumContentions;
+    totemLock_Release(&freeList->Lock);
+    
+    return totemBool_True;
+}
+
+void totem_PrintMemoryStats(FILE *file)
+{
+    totemMemoryStats stats;
+    totem_GetMemoryStats(&stats);
+    
+    fprintf(file, "page size: %zu, size classes: %zu, pages held: %zu (%zu bytes)\n", stats.PageSize, stats.NumSizeClasses, stats.NumPages, stats.NumPages * stats.PageSize);
+    fprintf(file, "%10s %10s %10s %10s %10s %10s %12s\n", "size", "pages", "live", "cached", "free", "peak", "contention");
+    
+    for (size_t i = 0; i < stats.NumSizeClasses; i++)
+    {
+        totemMemorySizeClassStats classStats;
+        totem_GetSizeClassStats(i, &classStats);
+        
+        // skip classes that have never been touched
+        if (classStats.PeakLiveObjects == 0 && classStats.NumPages == 0)
+        {
+            continue;
+        }
+        
+        fprintf(file, "%10zu %10zu %10zu %10zu %10zu %10zu %12zu\n", classStats.ObjectSize, classStats.NumPages, classStats.NumLiveObjects, classStats.NumCachedObjects, classStats.NumFreeObjects, classStats.PeakLiveObjects, classStats.NumLockContentions);
+    }
+    
+    fprintf(file, "large allocations: %zu live (%zu bytes), %zu peak bytes, %zu total\n", stats.NumLargeAllocations, stats.NumLargeBytes, stats.PeakLargeBytes, stats.TotalLargeAllocations);
+}
+
+void *totem_CacheMalloc(size_t amount)
+{
+    if(amount > TOTEM_MEM_MAXOBJECTSIZE)
+    {
+        void *ptr = totem_Malloc(amount);
+        if (ptr)
+        {
+            totemMemory_TrackLarge(amount, totemBool_True);
+        }
+        
+        return ptr;
+    }
+    
+    void *ptr = NULL;
+    totemMemoryFreeList *freeList = totemMemoryFreeList_Get(amount);
+    if(freeList)
+    {
+        //printf("cache alloc %zu, actual %zu\n", amount, freeList->ObjectSize);
+        
+#if TOTEM_MEMOPT_THREAD_CACHE
+        totemMemoryMagazine *magazine = totemMemoryMagazine_Get(freeList);
+        if (magazine->HeadObject == NULL)
+        {
+            totemMemoryMagazine_Refill(magazine, freeList);
+        }
+        
+        totemMemoryPageObject *obj = magazine->HeadObject;
+        if (obj)
+        {
+            magazine->HeadObject = obj->Next;
+            magazine->NumObjects--;
+            ptr = obj;
+        }
+#else
+        totemMemoryFreeList_Lock(freeList);
+        ptr = totemMemoryFreeList_Pop(freeList);
+        totemLock_Release(&freeList->Lock);
+#endif
+    }
+    
+    return ptr;
+}
+
+void totem_CacheFree(void *ptr, size_t amount)
+{
+    if(!ptr)
+    {
+        return;
+    }
+    
+    if(amount > TOTEM_MEM_MAXOBJECTSIZE)
+    {
+        totem_Free(ptr);
+        totemMemory_TrackLarge(amount, totemBool_False);
+        return;
+    }
+    
+    totemMemoryFreeList *freeList = totemMemoryFreeList_Get(amount);
+    totemMemoryPageObject *obj = ptr;
+    
+#if TOTEM_MEMOPT_THREAD_CACHE
+    totemMemoryMagazine *magazine = totemMemoryMagazine_Get(freeList);
+    obj->Next = magazine->HeadObject;
+    magazine->HeadObject = obj;
+    magazine->NumObjects++;
+    
+    // keep half the magazine around so alternating alloc/free doesn't thrash the global list
+    if (magazine->NumObjects > freeList->MagazineSize)
+    {
+        totemMemoryMagazine_Spill(magazine, freeList, magazine->NumObjects - (freeList->MagazineSize / 2));
+    }
+#else
+    totemMemoryFreeList_Lock(freeList);
+    totemMemoryFreeList_Push(freeList, obj);
+    totemLock_Release(&freeList->Lock);
+#endif
+}
+
+#if TOTEM_MEMOPT_HUGEPAGES
+
+static void *totemMemory_MapHuge(size_t len, size_t align)
+{
+    // over-map so the region can be trimmed down to an aligned start
+    size_t mapLen = len + align;
+    char *mem = mmap(NULL, mapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (mem == MAP_FAILED)
+    {
+        return NULL;
+    }
+    
+    char *aligned = (char*)(((uintptr_t)mem + align - 1) & ~(uintptr_t)(align - 1));
+    size_t head = (size_t)(aligned - mem);
+    size_t tail = mapLen - head - len;
+    
+    if (head)
+    {
+        munmap(mem, head);
+    }
+    
+    if (tail)
+    {
+        munmap(aligned + len, tail);
+    }
+    
+    madvise(aligned, len, MADV_HUGEPAGE);
+    return aligned;
+}
+
+static inline TOTEM_INLINE totemBool totemMemoryArena_IsUsed(totemMemoryArena *arena, size_t page)
+{
+    return (arena->Used[page / 64] >> (page % 64)) & 1;
+}
+
+static void totemMemoryArena_SetUsed(totemMemoryArena *arena, size_t start, size_t num, totemBool used)
+{
+    for (size_t i = start; i < start + num; i++)
+    {
+        if (used)
+        {
+            arena->Used[i / 64] |= ((uint64_t)1 << (i % 64));
+        }
+        else
+        {
+            arena->Used[i / 64] &= ~((uint64_t)1 << (i % 64));
+        }
+    }
+}
+
+// arena lock must be held
+static void *totemMemoryArena_Alloc(totemMemoryArena *arena, size_t numPages)
+{
+    if (arena->NumFree < numPages)
+    {
+        return NULL;
+    }
+    
+    // first fit
+    size_t runStart = 0;
+    size_t runLength = 0;
+    
+    for (size_t i = 0; i < TOTEM_MEM_ARENA_NUMPAGES; i++)
+    {
+        if (totemMemoryArena_IsUsed(arena, i))
+        {
+            runStart = i + 1;
+            runLength = 0;
+            continue;
+        }
+        
+        runLength++;
+        if (runLength == numPages)
+        {
+            totemMemoryArena_SetUsed(arena, runStart, numPages, totemBool_True);
+            arena->NumFree -= numPages;
+            return arena->Data + (runStart * TOTEM_MEM_PAGESIZE);
+        }
+    }
+    
+    return NULL;
+}
+
+// arena lock must be held
+static void *totemMemoryHugeMap_Alloc(size_t size)
+{
+    totemMemoryHugeMap *map = totem_CacheMalloc(sizeof(totemMemoryHugeMap));
+    if (!map)
+    {
+        return NULL;
+    }
+    
+    map->Data = totemMemory_MapHuge(size, TOTEM_MEM_ARENASIZE);
+    if (!map->Data)
+    {
+        totem_CacheFree(map, sizeof(totemMemoryHugeMap));
+        return NULL;
+    }
+    
+    map->Size = size;
+    map->Next = s_HugeMaps;
+    s_HugeMaps = map;
+    return map->Data;
+}
+
+// arena lock must be held
+static void *totemMemoryArena_AllocAny(size_t numPages)
+{
+    void *ptr = NULL;
+    
+    for (totemMemoryArena *arena = s_Arenas; arena != NULL && ptr == NULL; arena = arena->Next)
+    {
+        ptr = totemMemoryArena_Alloc(arena, numPages);
+    }
+    
+    if (!ptr)
+    {
+        totemMemoryArena *arena = totem_CacheMalloc(sizeof(totemMemoryArena));
+        if (arena)
+        {
+            arena->Data = totemMemory_MapHuge(TOTEM_MEM_ARENASIZE, TOTEM_MEM_ARENASIZE);
+            if (arena->Data)
+            {
+                memset(arena->Used, 0, sizeof(arena->Used));
+                arena->NumFree = TOTEM_MEM_ARENA_NUMPAGES;
+                arena->Next = s_Arenas;
+                s_Arenas = arena;
+                ptr = totemMemoryArena_Alloc(arena, numPages);
+            }
+            else
+            {
+                totem_CacheFree(arena, sizeof(totemMemoryArena));
+            }
+        }
+    }
+    
+    return ptr;
+}
+
+// arena lock must be held, returns false if the block didn't come from an arena or huge map
+static totemBool totemMemoryArena_FreeAny(void *ptr, size_t numPages)
+{
+    totemMemoryArena *prev = NULL;
+    for (totemMemoryArena *arena = s_Arenas; arena != NULL; prev = arena, arena = arena->Next)
+    {
+        if ((char*)ptr >= arena->Data && (char*)ptr < arena->Data + TOTEM_MEM_ARENASIZE)
+        {
+            size_t start = (size_t)((char*)ptr - arena->Data) / TOTEM_MEM_PAGESIZE;
+            totemMemoryArena_SetUsed(arena, start, numPages, totemBool_False);
+            arena->NumFree += numPages;
+            
+            // hand completely unused arenas back, but keep the head around to avoid map/unmap churn
+            if (arena->NumFree == TOTEM_MEM_ARENA_NUMPAGES && arena != s_Arenas)
+            {
+                prev->Next = arena->Next;
+                munmap(arena->Data, TOTEM_MEM_ARENASIZE);
+                totem_CacheFree(arena, sizeof(totemMemoryArena));
+            }
+            
+            return totemBool_True;
+        }
+    }
+    
+    totemMemoryHugeMap **link = &s_HugeMaps;
+    for (totemMemoryHugeMap *map = s_HugeMaps; map != NULL; link = &map->Next, map = map->Next)
+    {
+        if (map->Data == ptr)
+        {
+            *link = map->Next;
+            munmap(map->Data, map->Size);
+            totem_CacheFree(map, sizeof(totemMemoryHugeMap));
+            return totemBool_True;
+        }
+    }
+    
+    return totemBool_False;
+}
+
+#endif
+
+void *totem_LargeMalloc(size_t amount)
+{
+#if TOTEM_MEMOPT_HUGEPAGES
+    if (amount >= TOTEM_MEM_ARENA_MINSIZE && !mallocCb)
+    {
+        size_t numPages = (amount + TOTEM_MEM_PAGESIZE - 1) / TOTEM_MEM_PAGESIZE;
+        void *ptr = NULL;
+        
+        totemLock_Acquire(&s_ArenaLock);
+        
+        if (amount > TOTEM_MEM_ARENA_MAXSIZE)
+        {
+            ptr = totemMemoryHugeMap_Alloc(numPages * TOTEM_MEM_PAGESIZE);
+        }
+        else
+        {
+            ptr = totemMemoryArena_AllocAny(numPages);
+        }
+        
+        totemLock_Release(&s_ArenaLock);
+        
+        if (ptr)
+        {
+            totemMemory_TrackLarge(amount, totemBool_True);
+            return ptr;
+        }
+        
+        // no address space left for another mapping, the size-class cache may still manage
+    }
+#endif
+    
+    return totem_CacheMalloc(amount);
 }
 
-void totem_Free(void *mem)
+// blocks are routed by address rather than by the callbacks currently set, as they may have changed since the block was allocated
+void totem_LargeFree(void *ptr, size_t amount)
 {
-    //printf("freeing %zu\n", --allocs);
-    if (freeCb)
+    if (!ptr)
     {
-        freeCb(mem);
+        return;
     }
-    else
+    
+#if TOTEM_MEMOPT_HUGEPAGES
+    if (amount >= TOTEM_MEM_ARENA_MINSIZE)
     {
-        free(mem);
+        size_t numPages = (amount + TOTEM_MEM_PAGESIZE - 1) / TOTEM_MEM_PAGESIZE;
+        
+        totemLock_Acquire(&s_ArenaLock);
+        totemBool found = totemMemoryArena_FreeAny(ptr, numPages);
+        totemLock_Release(&s_ArenaLock);
+        
+        if (found)
+        {
+            totemMemory_TrackLarge(amount, totemBool_False);
+            return;
+        }
     }
+#endif
+    
+    totem_CacheFree(ptr, amount);
 }
 
-void totem_InitMemory()
+static void *totemAllocator_DefaultAlloc(totemAllocator *allocator, size_t size)
 {
-    memset(&s_FreeLists, 0, sizeof(s_FreeLists));
-    for (size_t i = 0; i < TOTEM_MEM_NUM_FREELISTS; i++)
-    {
-        totemMemoryFreeList *freeList = &s_FreeLists[i];
-        totemLock_Init(&freeList->Lock);
-        freeList->ObjectSize = (i + 1) * sizeof(totemMemoryPageObject);
-    }
-    
-    mallocCb = NULL;
-    freeCb = NULL;
+    return totem_LargeMalloc(size);
 }
 
-void totem_CleanupMemory()
+static void totemAllocator_DefaultFree(totemAllocator *allocator, void *ptr, size_t size)
 {
-    for (size_t i = 0; i < TOTEM_MEM_NUM_FREELISTS; i++)
-    {
-        totemMemoryFreeList *freeList = &s_FreeLists[i];
-        for (totemMemoryPage *page = freeList->HeadPage; page != NULL; /* nada */)
-        {
-            totemMemoryPage *next = page->Next;
-            totem_Free(page);
-            page = next;
-        }
-        
-        totemLock_Cleanup(&freeList->Lock);
-    }
+    totem_LargeFree(ptr, size);
 }
 
-void totem_SetMemoryCallbacks(totemMallocCb newMallocCb, totemFreeCb newFreeCb)
+void totemAllocator_InitDefault(totemAllocator *allocator)
 {
-    mallocCb = newMallocCb;
-    freeCb = newFreeCb;
+    memset(allocator, 0, sizeof(totemAllocator));
+    allocator->Alloc = totemAllocator_DefaultAlloc;
+    allocator->Free = totemAllocator_DefaultFree;
 }
 
-totemMemoryFreeList *totemMemoryFreeList_Get(size_t amount)
+void totemAllocator_ResetStats(totemAllocator *allocator)
 {
-    if(amount > TOTEM_MEM_PAGESIZE)
+    allocator->NumBytes = 0;
+    allocator->PeakBytes = 0;
+    allocator->NumAllocations = 0;
+}
+
+void *totemAllocator_Alloc(totemAllocator *allocator, size_t size)
+{
+    void *ptr = allocator->Alloc(allocator, size);
+    if (ptr)
     {
-        return NULL;
+        allocator->NumBytes += size;
+        allocator->NumAllocations++;
+        
+        if (allocator->NumBytes > allocator->PeakBytes)
+        {
+            allocator->PeakBytes = allocator->NumBytes;
+        }
     }
     
-    if(amount < sizeof(totemMemoryPageObject))
+    return ptr;
+}
+
+void totemAllocator_Free(totemAllocator *allocator, void *ptr, size_t size)
+{
+    if (!ptr)
     {
-        amount = sizeof(totemMemoryPageObject);
+        return;
     }
     
-    size_t index = amount / TOTEM_MEM_FREELIST_DIVISOR;
-    index += (amount % TOTEM_MEM_FREELIST_DIVISOR != 0);
-    index--;
-    
-    totemMemoryFreeList *list = &s_FreeLists[index];
-    
-    totem_assert(amount <= list->ObjectSize);
-    totem_assert(list == &s_FreeLists[0] ? 1 : amount > (list - 1)->ObjectSize);
-    
-    return list;
+    allocator->Free(allocator, ptr, size);
+    allocator->NumBytes -= size;
+    allocator->NumAllocations--;
 }
 
-void *totem_CacheMalloc(size_t amount)
+void *totemAllocator_Realloc(totemAllocator *allocator, void *ptr, size_t oldSize, size_t newSize)
 {
-    if(amount > TOTEM_MEM_PAGESIZE)
+    if (!ptr)
     {
-        return totem_Malloc(amount);
+        return totemAllocator_Alloc(allocator, newSize);
     }
     
-    void *ptr = NULL;
-    totemMemoryFreeList *freeList = totemMemoryFreeList_Get(amount);
-    if(freeList)
+    void *newPtr = NULL;
+    
+    if (allocator->Realloc)
     {
-        totemLock_Acquire(&freeList->Lock);
-        totemMemoryPageObject *head = freeList->HeadObject;
-        
-        //printf("cache alloc %zu, actual %zu\n", amount, actualAmount);
-        
-        // check freelist first
-        if(head != NULL)
+        newPtr = allocator->Realloc(allocator, ptr, oldSize, newSize);
+        if (!newPtr)
         {
-            totemMemoryPageObject *obj = head;
-            freeList->HeadObject = obj->Next;
-            ptr = obj;
+            return NULL;
         }
-        else
+    }
+    else
+    {
+        newPtr = allocator->Alloc(allocator, newSize);
+        if (!newPtr)
         {
-            // look for a new allocation in cached pages
-            if (freeList->HeadPage)
-            {
-                totemMemoryPage *page = freeList->HeadPage;
-                if (page->NumAllocated < page->NumTotal)
-                {
-                    totemMemoryPageObject *obj = (totemMemoryPageObject*)(page->Data + (page->NumAllocated * freeList->ObjectSize));
-                    page->NumAllocated++;
-                    ptr = obj;
-                }
-            }
-            
-            if (!ptr)
-            {
-                // grab a new page & allocate from that
-                totemMemoryPage *newPage = totem_Malloc(sizeof(totemMemoryPage));
-                if (newPage != NULL)
-                {
-                    newPage->NumTotal = TOTEM_MEM_PAGESIZE / freeList->ObjectSize;
-                    newPage->Next = freeList->HeadPage;
-                    freeList->HeadPage = newPage;
-                    newPage->NumAllocated = 1;
-                    ptr = newPage->Data;
-                }
-            }
+            return NULL;
         }
         
-        totemLock_Release(&freeList->Lock);
+        memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+        allocator->Free(allocator, ptr, oldSize);
     }
     
-    return ptr;
-}
-
-void totem_CacheFree(void *ptr, size_t amount)
-{
-    if(!ptr)
-    {
-        return;
-    }
+    allocator->NumBytes += newSize;
+    allocator->NumBytes -= oldSize;
     
-    if(amount > TOTEM_MEM_PAGESIZE)
+    if (allocator->NumBytes > allocator->PeakBytes)
     {
-        totem_Free(ptr);
-        return;
+        allocator->PeakBytes = allocator->NumBytes;
     }
     
-    totemMemoryFreeList *freeList = totemMemoryFreeList_Get(amount);
-    totemMemoryPageObject *obj = ptr;
-    
-    totemLock_Acquire(&freeList->Lock);
-    obj->Next = freeList->HeadObject;
-    freeList->HeadObject = obj;
-    totemLock_Release(&freeList->Lock);
+    return newPtr;
 }
 
 void totemMemoryBlock_Cleanup(totemMemoryBlock **blockHead)
@@ -337,291 +1440,539 @@ void *totemMemoryBuffer_Insert(totemMemoryBuffer *buffer, void *data, size_t num
     return ptr;
 }
 
-void *totemMemoryBuffer_SecureDirect(totemMemoryBuffer *buffer, size_t amount)
+void *totemMemoryBuffer_SecureDirect(totemMemoryBuffer *buffer, size_t amount)
+{
+    char *memEnd = buffer->Data + buffer->MaxLength;
+    char *memCurrent = buffer->Data + buffer->Length;
+    
+    if(memCurrent + amount >= memEnd)
+    {
+        size_t toAlloc = buffer->MaxLength;
+        
+        if(buffer->MaxLength == 0)
+        {
+            toAlloc = buffer->ObjectSize * 32;
+        }
+        else
+        {
+            toAlloc *= 2;
+        }
+        
+        if(amount + buffer->Length > toAlloc)
+        {
+            toAlloc = amount + buffer->Length;
+        }
+        
+        char *newMem = totem_CacheMalloc(toAlloc);
+        
+        if(newMem == NULL)
+        {
+            return NULL;
+        }
+        
+        memcpy(newMem, buffer->Data, buffer->MaxLength);
+        memset(newMem + buffer->MaxLength, 0, toAlloc - buffer->MaxLength);
+        
+        totem_CacheFree(buffer->Data, buffer->MaxLength);
+        
+        buffer->MaxLength = toAlloc;
+        buffer->Data = newMem;
+    }
+    
+    void *ptr = buffer->Data + buffer->Length;
+    buffer->Length += amount;
+    return ptr;
+}
+
+totemBool totemMemoryBuffer_Reserve(totemMemoryBuffer *buffer, size_t amount)
+{
+    amount *= buffer->ObjectSize;
+    
+    if (buffer->MaxLength < amount)
+    {
+        size_t currentAmount = buffer->Length;
+        
+        if (totemMemoryBuffer_SecureDirect(buffer, amount - buffer->MaxLength) == NULL)
+        {
+            return totemBool_False;
+        }
+        
+        buffer->Length = currentAmount;
+    }
+    
+    return totemBool_True;
+}
+
+void *totemMemoryBuffer_Secure(totemMemoryBuffer *buffer, size_t amount)
+{
+    amount *= buffer->ObjectSize;
+    return totemMemoryBuffer_SecureDirect(buffer, amount);
+}
+
+void *totemMemoryBuffer_TakeFrom(totemMemoryBuffer *buffer, totemMemoryBuffer *takeFrom)
+{
+    void *ptr = totemMemoryBuffer_SecureDirect(buffer, takeFrom->Length);
+    if(!ptr)
+    {
+        return NULL;
+    }
+    
+    memcpy(ptr, takeFrom->Data, takeFrom->Length);
+    return ptr;
+}
+
+void *totemMemoryBuffer_Get(totemMemoryBuffer *buffer, size_t index)
+{
+    index *= buffer->ObjectSize;
+    if(index < buffer->MaxLength)
+    {
+        return (void*)&buffer->Data[index];
+    }
+    
+    return NULL;
+}
+
+size_t totemMemoryBuffer_GetNumObjects(totemMemoryBuffer *buffer)
+{
+    return buffer->Length / buffer->ObjectSize;
+}
+
+size_t totemMemoryBuffer_GetMaxObjects(totemMemoryBuffer *buffer)
+{
+    return buffer->MaxLength / buffer->ObjectSize;
+}
+
+/*
+ control bytes
+ - full slots hold the low 7 bits of the entry hash, so are always >= 0
+ - empty & deleted slots are negative, and are told apart from each other with a single compare
+ - the first group of control bytes is mirrored past the end of the array, so a group can be loaded from any slot without wrapping
+ */
+#define TOTEM_HASHMAP_CONTROL_EMPTY ((int8_t)-128)
+#define TOTEM_HASHMAP_CONTROL_DELETED ((int8_t)-2)
+#define TOTEM_HASHMAP_CONTROL_SENTINEL ((int8_t)-1)
+#define TOTEM_HASHMAP_H1(hash) ((size_t)((hash) >> 7))
+#define TOTEM_HASHMAP_H2(hash) ((int8_t)((hash) & 0x7F))
+
+#if defined(__SSE2__) || defined(TOTEM_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TOTEM_HASHMAP_SSE2
+#define TOTEM_HASHMAP_GROUPWIDTH (16)
+#define TOTEM_HASHMAP_MASKSHIFT (0)
+typedef uint32_t totemHashMapMask;
+#else
+#define TOTEM_HASHMAP_GROUPWIDTH (8)
+#define TOTEM_HASHMAP_MASKSHIFT (3)
+#define TOTEM_HASHMAP_LSBS (0x0101010101010101ULL)
+#define TOTEM_HASHMAP_MSBS (0x8080808080808080ULL)
+typedef uint64_t totemHashMapMask;
+#endif
+
+// smallest table, 7/8ths of which may be filled before growing
+#define TOTEM_HASHMAP_MINCAPACITY (TOTEM_HASHMAP_GROUPWIDTH * 2)
+#define TOTEM_HASHMAP_MAXLOAD(capacity) ((capacity) - ((capacity) / 8))
+
+// minimum number of old slots each insert moves across while a resize is in progress
+#define TOTEM_HASHMAP_MIGRATESLOTS (16)
+
+static inline TOTEM_INLINE size_t totemHashMapMask_LowestIndex(totemHashMapMask mask)
+{
+#if defined(TOTEM_GNUC) || defined(TOTEM_CLANG)
+#ifdef TOTEM_HASHMAP_SSE2
+    return (size_t)__builtin_ctz(mask) >> TOTEM_HASHMAP_MASKSHIFT;
+#else
+    return (size_t)__builtin_ctzll(mask) >> TOTEM_HASHMAP_MASKSHIFT;
+#endif
+#else
+    size_t index = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        index++;
+    }
+    
+    return index >> TOTEM_HASHMAP_MASKSHIFT;
+#endif
+}
+
+#ifdef TOTEM_HASHMAP_SSE2
+
+static inline TOTEM_INLINE totemHashMapMask totemHashMap_MatchGroup(const int8_t *group, int8_t h2)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (totemHashMapMask)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+}
+
+static inline TOTEM_INLINE totemHashMapMask totemHashMap_MatchEmpty(const int8_t *group)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (totemHashMapMask)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(TOTEM_HASHMAP_CONTROL_EMPTY), ctrl));
+}
+
+static inline TOTEM_INLINE totemHashMapMask totemHashMap_MatchEmptyOrDeleted(const int8_t *group)
+{
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (totemHashMapMask)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(TOTEM_HASHMAP_CONTROL_SENTINEL), ctrl));
+}
+
+#else
+
+// portable fallback - 8 control bytes packed into a word, one result bit at the top of each byte
+static inline TOTEM_INLINE uint64_t totemHashMap_LoadGroup(const int8_t *group)
+{
+    uint64_t word = 0;
+    for (size_t i = 0; i < TOTEM_HASHMAP_GROUPWIDTH; i++)
+    {
+        word |= ((uint64_t)(uint8_t)group[i]) << (i * 8);
+    }
+    
+    return word;
+}
+
+static inline TOTEM_INLINE totemHashMapMask totemHashMap_MatchGroup(const int8_t *group, int8_t h2)
+{
+    // may report false positives, which are weeded out by the full hash & key compare
+    uint64_t x = totemHashMap_LoadGroup(group) ^ (TOTEM_HASHMAP_LSBS * (uint8_t)h2);
+    return (x - TOTEM_HASHMAP_LSBS) & ~x & TOTEM_HASHMAP_MSBS;
+}
+
+static inline TOTEM_INLINE totemHashMapMask totemHashMap_MatchEmpty(const int8_t *group)
+{
+    uint64_t ctrl = totemHashMap_LoadGroup(group);
+    return ctrl & (~ctrl << 6) & TOTEM_HASHMAP_MSBS;
+}
+
+static inline TOTEM_INLINE totemHashMapMask totemHashMap_MatchEmptyOrDeleted(const int8_t *group)
+{
+    uint64_t ctrl = totemHashMap_LoadGroup(group);
+    return ctrl & (~ctrl << 7) & TOTEM_HASHMAP_MSBS;
+}
+
+#endif
+
+static inline TOTEM_INLINE size_t totemHashMap_GetAllocSize(size_t capacity)
+{
+    size_t controlSize = capacity + TOTEM_HASHMAP_GROUPWIDTH;
+    controlSize = (controlSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    return controlSize + (capacity * sizeof(totemHashMapEntry));
+}
+
+static inline TOTEM_INLINE void totemHashMapTable_SetControl(totemHashMapTable *table, size_t index, int8_t ctrl)
+{
+    table->Controls[index] = ctrl;
+    
+    if (index < TOTEM_HASHMAP_GROUPWIDTH)
+    {
+        table->Controls[table->Capacity + index] = ctrl;
+    }
+}
+
+static size_t totemHashMapTable_AssertList(totemHashMapTable *table, totemBool checkGrowth)
 {
-    char *memEnd = buffer->Data + buffer->MaxLength;
-    char *memCurrent = buffer->Data + buffer->Length;
+    size_t numKeys = 0;
+    size_t numDeleted = 0;
     
-    if(memCurrent + amount >= memEnd)
+    for (size_t i = 0; i < table->Capacity; i++)
     {
-        size_t toAlloc = buffer->MaxLength;
-        
-        if(buffer->MaxLength == 0)
+        if (table->Controls[i] >= 0)
         {
-            toAlloc = buffer->ObjectSize * 32;
-        }
-        else
-        {
-            toAlloc *= 2;
+            numKeys++;
         }
-        
-        if(amount + buffer->Length > toAlloc)
+        else if (table->Controls[i] == TOTEM_HASHMAP_CONTROL_DELETED)
         {
-            toAlloc = amount + buffer->Length;
+            numDeleted++;
         }
         
-        char *newMem = totem_CacheMalloc(toAlloc);
-        
-        if(newMem == NULL)
+        if (i < TOTEM_HASHMAP_GROUPWIDTH)
         {
-            return NULL;
+            totem_assert(table->Controls[i] == table->Controls[table->Capacity + i]);
         }
-        
-        memcpy(newMem, buffer->Data, buffer->MaxLength);
-        memset(newMem + buffer->MaxLength, 0, toAlloc - buffer->MaxLength);
-        
-        totem_CacheFree(buffer->Data, buffer->MaxLength);
-        
-        buffer->MaxLength = toAlloc;
-        buffer->Data = newMem;
     }
     
-    void *ptr = buffer->Data + buffer->Length;
-    buffer->Length += amount;
-    return ptr;
+    totem_assert(!checkGrowth || table->Capacity == 0 || numKeys + numDeleted + table->GrowthLeft == TOTEM_HASHMAP_MAXLOAD(table->Capacity));
+    return numKeys;
 }
 
-totemBool totemMemoryBuffer_Reserve(totemMemoryBuffer *buffer, size_t amount)
+void totemHashMap_AssertList(totemHashMap *hashmap)
 {
-    amount *= buffer->ObjectSize;
-    
-    if (buffer->MaxLength < amount)
-    {
-        size_t currentAmount = buffer->Length;
-        
-        if (totemMemoryBuffer_SecureDirect(buffer, amount - buffer->MaxLength) == NULL)
-        {
-            return totemBool_False;
-        }
-        
-        buffer->Length = currentAmount;
-    }
+    size_t numKeys = totemHashMapTable_AssertList(&hashmap->Table, totemBool_True);
+    numKeys += totemHashMapTable_AssertList(&hashmap->Old, totemBool_False);
     
-    return totemBool_True;
-}
-
-void *totemMemoryBuffer_Secure(totemMemoryBuffer *buffer, size_t amount)
-{
-    amount *= buffer->ObjectSize;
-    return totemMemoryBuffer_SecureDirect(buffer, amount);
+    totem_assert(numKeys == hashmap->NumKeys);
+    totem_assert(hashmap->Old.Capacity == 0 || hashmap->MigrateIndex < hashmap->Old.Capacity);
+    totem_assert(hashmap->NumFreeValues <= hashmap->MaxFreeValues);
 }
 
-void *totemMemoryBuffer_TakeFrom(totemMemoryBuffer *buffer, totemMemoryBuffer *takeFrom)
+static inline TOTEM_INLINE void *totemHashMap_Malloc(totemHashMap *hashmap, size_t len)
 {
-    void *ptr = totemMemoryBuffer_SecureDirect(buffer, takeFrom->Length);
-    if(!ptr)
+    if (hashmap->Allocator)
     {
-        return NULL;
+        return totemAllocator_Alloc(hashmap->Allocator, len);
     }
     
-    memcpy(ptr, takeFrom->Data, takeFrom->Length);
-    return ptr;
+    return totem_CacheMalloc(len);
 }
 
-void *totemMemoryBuffer_Get(totemMemoryBuffer *buffer, size_t index)
+static inline TOTEM_INLINE void totemHashMap_Free(totemHashMap *hashmap, void *ptr, size_t len)
 {
-    index *= buffer->ObjectSize;
-    if(index < buffer->MaxLength)
+    if (hashmap->Allocator)
     {
-        return (void*)&buffer->Data[index];
+        totemAllocator_Free(hashmap->Allocator, ptr, len);
+        return;
     }
     
-    return NULL;
+    totem_CacheFree(ptr, len);
 }
 
-size_t totemMemoryBuffer_GetNumObjects(totemMemoryBuffer *buffer)
+void totemHashMap_Init(totemHashMap *hashmap)
 {
-    return buffer->Length / buffer->ObjectSize;
+    memset(hashmap, 0, sizeof(totemHashMap));
+    totemHashMap_Assert(hashmap);
 }
 
-size_t totemMemoryBuffer_GetMaxObjects(totemMemoryBuffer *buffer)
+static void totemHashMap_FreeTable(totemHashMap *hashmap, totemHashMapTable *table)
 {
-    return buffer->MaxLength / buffer->ObjectSize;
+    if (table->Controls)
+    {
+        totemHashMap_Free(hashmap, table->Controls, totemHashMap_GetAllocSize(table->Capacity));
+    }
+    
+    memset(table, 0, sizeof(totemHashMapTable));
 }
 
-void totemHashMap_AssertList(totemHashMap *hashmap)
+static void totemHashMap_PushFreeValue(totemHashMap *hashmap, totemHashValue value)
 {
-    for (size_t i = 0; i < hashmap->NumBuckets; i++)
+    if (hashmap->NumFreeValues == hashmap->MaxFreeValues)
     {
-        totemHashMapEntry *bucket = hashmap->Buckets[i];
+        size_t newMax = hashmap->MaxFreeValues ? hashmap->MaxFreeValues * 2 : 8;
+        totemHashValue *newValues = totemHashMap_Malloc(hashmap, sizeof(totemHashValue) * newMax);
+        if (!newValues)
+        {
+            // value simply won't be reused
+            return;
+        }
         
-        for (size_t k = 0; bucket; k++)
+        if (hashmap->FreeValues)
         {
-            totem_assert(k < 50000);
-            bucket = bucket->Next;
+            memcpy(newValues, hashmap->FreeValues, sizeof(totemHashValue) * hashmap->NumFreeValues);
+            totemHashMap_Free(hashmap, hashmap->FreeValues, sizeof(totemHashValue) * hashmap->MaxFreeValues);
         }
+        
+        hashmap->FreeValues = newValues;
+        hashmap->MaxFreeValues = newMax;
     }
     
-    totemHashMapEntry *bucket = hashmap->FreeList;
-    
-    for (size_t i = 0; bucket; i++)
+    hashmap->FreeValues[hashmap->NumFreeValues++] = value;
+}
+
+totemBool totemHashMap_PeekFreeValue(totemHashMap *hashmap, totemHashValue *valueOut)
+{
+    if (hashmap->NumFreeValues)
     {
-        totem_assert(i < 50000);
-        bucket = bucket->Next;
+        *valueOut = hashmap->FreeValues[hashmap->NumFreeValues - 1];
+        return totemBool_True;
     }
+    
+    return totemBool_False;
 }
 
-void totemHashMap_Init(totemHashMap *hashmap)
+static inline TOTEM_INLINE void totemHashMap_FreeKey(totemHashMap *hashmap, totemHashMapEntry *entry)
 {
-    memset(hashmap, 0, sizeof(totemHashMap));
-    totemHashMap_Assert(hashmap);
+    if (entry->KeyLen > TOTEM_HASHMAP_INLINEKEYSIZE)
+    {
+        totemHashMap_Free(hashmap, (void*)entry->Key, entry->KeyLen);
+    }
 }
 
-void totemHashMap_FreeEntry(totemHashMap *hashmap, totemHashMapEntry *entry)
+static void totemHashMap_FreeEntry(totemHashMap *hashmap, totemHashMapTable *table, size_t index)
 {
-    totemHashMap_Assert(hashmap);
-    totem_CacheFree((void*)entry->Key, entry->KeyLen);
-    
-    entry->Next = hashmap->FreeList;
-    hashmap->FreeList = entry;
-    totemHashMap_Assert(hashmap);
+    totemHashMapEntry *entry = table->Entries + index;
+    totemHashMap_FreeKey(hashmap, entry);
+    totemHashMap_PushFreeValue(hashmap, entry->Value);
+    totemHashMapTable_SetControl(table, index, TOTEM_HASHMAP_CONTROL_DELETED);
 }
 
-totemHashMapEntry *totemHashMap_SecureEntry(totemHashMap *hashmap)
+// first empty or deleted slot along the probe sequence for this hash
+static inline TOTEM_INLINE size_t totemHashMapTable_FindInsertSlot(totemHashMapTable *table, totemHash hash)
 {
-    totemHashMapEntry *entry = NULL;
+    size_t mask = table->Capacity - 1;
+    size_t pos = TOTEM_HASHMAP_H1(hash) & mask;
     
-    if (hashmap->FreeList)
+    for (size_t stride = TOTEM_HASHMAP_GROUPWIDTH; ; stride += TOTEM_HASHMAP_GROUPWIDTH)
     {
-        totemHashMap_Assert(hashmap);
-        entry = hashmap->FreeList;
-        hashmap->FreeList = entry->Next;
-        totemHashMap_Assert(hashmap);
+        totemHashMapMask match = totemHashMap_MatchEmptyOrDeleted(table->Controls + pos);
+        if (match)
+        {
+            return (pos + totemHashMapMask_LowestIndex(match)) & mask;
+        }
+        
+        pos = (pos + stride) & mask;
     }
-    else
+}
+
+// moves an entry known not to be in the table already - no key compare & no key copy
+static void totemHashMapTable_InsertMoved(totemHashMapTable *table, totemHashMapEntry *entry)
+{
+    size_t index = totemHashMapTable_FindInsertSlot(table, entry->Hash);
+    if (table->Controls[index] == TOTEM_HASHMAP_CONTROL_EMPTY)
     {
-        totemHashMap_Assert(hashmap);
-        entry = totem_CacheMalloc(sizeof(totemHashMapEntry));
-        totemHashMap_Assert(hashmap);
+        table->GrowthLeft--;
     }
     
-    totemHashMap_Assert(hashmap);
-    return entry;
+    totemHashMapTable_SetControl(table, index, TOTEM_HASHMAP_H2(entry->Hash));
+    
+    totemHashMapEntry *newEntry = table->Entries + index;
+    *newEntry = *entry;
+    if (newEntry->KeyLen <= TOTEM_HASHMAP_INLINEKEYSIZE)
+    {
+        newEntry->Key = newEntry->InlineKey;
+    }
 }
 
-void totemHashMap_MoveKeysToFreeList(totemHashMap *hashmap)
+/*
+ migrate up to numSlots slots from the old table into the current one
+ - migrated slots are left as tombstones, so lookups still probing the old table step over them
+ - the old table is released once the last slot has been moved
+ */
+static void totemHashMap_Migrate(totemHashMap *hashmap, size_t numSlots)
 {
-    totemHashMap_Assert(hashmap);
+    totemHashMapTable *old = &hashmap->Old;
+    size_t end = hashmap->MigrateIndex + numSlots;
+    if (end > old->Capacity)
+    {
+        end = old->Capacity;
+    }
     
-    for(size_t i = 0; i < hashmap->NumBuckets; i++)
+    for (size_t i = hashmap->MigrateIndex; i < end; i++)
     {
-        totemHashMap_Assert(hashmap);
-        while(hashmap->Buckets[i])
+        if (old->Controls[i] >= 0)
         {
-            totemHashMap_Assert(hashmap);
-            totemHashMapEntry *entry = hashmap->Buckets[i];
-            hashmap->Buckets[i] = entry->Next;
-            totemHashMap_Assert(hashmap);
-            totemHashMap_FreeEntry(hashmap, entry);
-            totemHashMap_Assert(hashmap);
+            totemHashMapTable_InsertMoved(&hashmap->Table, old->Entries + i);
+            totemHashMapTable_SetControl(old, i, TOTEM_HASHMAP_CONTROL_DELETED);
         }
-        totemHashMap_Assert(hashmap);
     }
-    totemHashMap_Assert(hashmap);
     
-    totemHashMap_Assert(hashmap);
+    hashmap->MigrateIndex = end;
     
-    hashmap->NumKeys = 0;
+    if (hashmap->MigrateIndex == old->Capacity)
+    {
+        totemHashMap_FreeTable(hashmap, old);
+        hashmap->MigrateIndex = 0;
+    }
 }
 
-void totemHashMap_InsertDirect(totemHashMapEntry **buckets, size_t numBuckets, totemHashMapEntry *entry)
+/*
+ swap in a new table, sized so that it can absorb the old table's keys plus at least as many inserts again
+ - keys are moved across a few slots at a time by subsequent inserts rather than all at once
+ - when mostly tombstones, the new table can end up the same size as the old one
+ */
+static totemBool totemHashMap_Grow(totemHashMap *hashmap)
 {
-    size_t index = entry->Hash % numBuckets;
-    if(buckets[index] == NULL)
+    totemHashMap_Assert(hashmap);
+    
+    // migration is paced to finish before this can happen, but just in case
+    if (hashmap->Old.Capacity)
     {
-        buckets[index] = entry;
+        totemHashMap_Migrate(hashmap, hashmap->Old.Capacity);
     }
-    else
+    
+    size_t newCapacity = TOTEM_HASHMAP_MINCAPACITY;
+    while (TOTEM_HASHMAP_MAXLOAD(newCapacity) / 2 < hashmap->NumKeys + 1)
     {
-        for(totemHashMapEntry *bucket = buckets[index]; bucket != NULL; bucket = bucket->Next)
-        {
-            if(bucket->Next == NULL)
-            {
-                bucket->Next = entry;
-                break;
-            }
-        }
+        newCapacity *= 2;
+    }
+    
+    size_t allocSize = totemHashMap_GetAllocSize(newCapacity);
+    char *mem = totemHashMap_Malloc(hashmap, allocSize);
+    if (!mem)
+    {
+        return totemBool_False;
+    }
+    
+    hashmap->Old = hashmap->Table;
+    hashmap->MigrateIndex = 0;
+    
+    // pace the migration so it always completes before the new table itself fills up
+    size_t headroom = TOTEM_HASHMAP_MAXLOAD(newCapacity) / 2;
+    hashmap->MigrateStep = (hashmap->Old.Capacity / headroom) + 1;
+    if (hashmap->MigrateStep < TOTEM_HASHMAP_MIGRATESLOTS)
+    {
+        hashmap->MigrateStep = TOTEM_HASHMAP_MIGRATESLOTS;
     }
+    
+    totemHashMapTable *table = &hashmap->Table;
+    table->Controls = (int8_t*)mem;
+    table->Entries = (totemHashMapEntry*)(mem + (allocSize - (newCapacity * sizeof(totemHashMapEntry))));
+    table->Capacity = newCapacity;
+    table->GrowthLeft = TOTEM_HASHMAP_MAXLOAD(newCapacity);
+    memset(table->Controls, TOTEM_HASHMAP_CONTROL_EMPTY, newCapacity + TOTEM_HASHMAP_GROUPWIDTH);
+    
+    if (hashmap->Old.Capacity == 0)
+    {
+        // first allocation, nothing to migrate
+        totemHashMap_FreeTable(hashmap, &hashmap->Old);
+    }
+    
+    totemHashMap_Assert(hashmap);
+    return totemBool_True;
 }
 
 totemBool totemHashMap_InsertPrecomputedWithoutSearch(totemHashMap *hashmap, const void *key, size_t keyLen, totemHashValue value, totemHash hash)
 {
     totemHashMap_Assert(hashmap);
-    if (hashmap->NumKeys >= hashmap->NumBuckets)
+    
+    if (hashmap->Old.Capacity)
     {
-        totemHashMap_Assert(hashmap);
-        // buckets realloc
-        size_t newNumBuckets = 0;
-        if (hashmap->NumKeys == 0)
-        {
-            newNumBuckets = 32;
-        }
-        else
-        {
-            newNumBuckets = hashmap->NumKeys * 2;
-        }
-        
-        totemHashMap_Assert(hashmap);
-        totemHashMapEntry **newBuckets = totem_CacheMalloc(sizeof(totemHashMapEntry**) * newNumBuckets);
-        if (!newBuckets)
+        totemHashMap_Migrate(hashmap, hashmap->MigrateStep);
+    }
+    
+    totemHashMapTable *table = &hashmap->Table;
+    size_t index = 0;
+    if (table->Capacity)
+    {
+        index = totemHashMapTable_FindInsertSlot(table, hash);
+    }
+    
+    // deleted slots can always be reused, empty ones eat into the load factor
+    if (table->Capacity == 0 || (table->GrowthLeft == 0 && table->Controls[index] == TOTEM_HASHMAP_CONTROL_EMPTY))
+    {
+        if (!totemHashMap_Grow(hashmap))
         {
-            totemHashMap_Assert(hashmap);
             return totemBool_False;
         }
         
-        totemHashMap_Assert(hashmap);
-        // reassign
-        memset(newBuckets, 0, newNumBuckets * sizeof(totemHashMapEntry**));
-        for (size_t i = 0; i < hashmap->NumBuckets; i++)
+        index = totemHashMapTable_FindInsertSlot(table, hash);
+    }
+    
+    totemHashMapEntry *entry = table->Entries + index;
+    char *persistKey = entry->InlineKey;
+    if (keyLen > TOTEM_HASHMAP_INLINEKEYSIZE)
+    {
+        persistKey = totemHashMap_Malloc(hashmap, keyLen);
+        if (!persistKey)
         {
-            totemHashMap_Assert(hashmap);
-            totemHashMapEntry *next = NULL;
-            for (totemHashMapEntry *entry = hashmap->Buckets[i]; entry != NULL; entry = next)
-            {
-                totemHashMap_Assert(hashmap);
-                next = entry->Next;
-                entry->Next = NULL;
-                totemHashMap_InsertDirect(newBuckets, newNumBuckets, entry);
-                totemHashMap_Assert(hashmap);
-            }
-            totemHashMap_Assert(hashmap);
+            return totemBool_False;
         }
-        
-        totemHashMap_Assert(hashmap);
-        // replace buckets
-        totem_CacheFree(hashmap->Buckets, sizeof(totemHashMapEntry**) * hashmap->NumBuckets);
-        hashmap->Buckets = newBuckets;
-        hashmap->NumBuckets = newNumBuckets;
-        totemHashMap_Assert(hashmap);
     }
     
-    totemHashMap_Assert(hashmap);
-    totemHashMapEntry *entry = totemHashMap_SecureEntry(hashmap);
-    if (!entry)
+    memcpy(persistKey, key, keyLen);
+    
+    if (table->Controls[index] == TOTEM_HASHMAP_CONTROL_EMPTY)
     {
-        totemHashMap_Assert(hashmap);
-        return totemBool_False;
+        table->GrowthLeft--;
     }
     
-    totemHashMap_Assert(hashmap);
-    void *persistKey = totem_CacheMalloc(keyLen);
-    if (!persistKey)
+    // the next insert always consumes the top of the freelist, so callers can peek it to reuse values
+    if (hashmap->NumFreeValues)
     {
-        return totemBool_False;
+        hashmap->NumFreeValues--;
     }
     
-    totemHashMap_Assert(hashmap);
-    memcpy(persistKey, key, keyLen);
-    totemHashMap_Assert(hashmap);
-    
-    entry->Next = NULL;
     entry->Value = value;
     entry->Key = persistKey;
     entry->KeyLen = keyLen;
     entry->Hash = hash;
-    totemHashMap_Assert(hashmap);
-    totemHashMap_InsertDirect(hashmap->Buckets, hashmap->NumBuckets, entry);
-    totemHashMap_Assert(hashmap);
+    totemHashMapTable_SetControl(table, index, TOTEM_HASHMAP_H2(hash));
     
     hashmap->NumKeys++;
     totemHashMap_Assert(hashmap);
@@ -631,150 +1982,208 @@ totemBool totemHashMap_InsertPrecomputedWithoutSearch(totemHashMap *hashmap, con
 totemBool totemHashMap_InsertPrecomputed(totemHashMap *hashmap, const void *key, size_t keyLen, totemHashValue value, totemHash hash)
 {
     totemHashMap_Assert(hashmap);
-    totemHashMapEntry *existingEntry = totemHashMap_Find(hashmap, key, keyLen);
+    totemHashMapEntry *existingEntry = totemHashMap_FindPrecomputed(hashmap, key, keyLen, hash);
     if(existingEntry)
     {
-        totemHashMap_Assert(hashmap);
         existingEntry->Value = value;
-        totemHashMap_Assert(hashmap);
         return totemBool_True;
     }
-    else
-    {
-        totemHashMap_Assert(hashmap);
-        totemBool result = totemHashMap_InsertPrecomputedWithoutSearch(hashmap, key, keyLen, value, hash);
-        totemHashMap_Assert(hashmap);
-        return result;
-    }
+    
+    return totemHashMap_InsertPrecomputedWithoutSearch(hashmap, key, keyLen, value, hash);
 }
 
 totemBool totemHashMap_Insert(totemHashMap *hashmap, const void *key, size_t keyLen, totemHashValue value)
 {
     totemHashMap_Assert(hashmap);
     totemHash hash = totem_Hash(key, keyLen);
-    totemHashMap_Assert(hashmap);
-    totemBool result = totemHashMap_InsertPrecomputed(hashmap, key, keyLen, value, hash);
-    totemHashMap_Assert(hashmap);
-    return result;
+    return totemHashMap_InsertPrecomputed(hashmap, key, keyLen, value, hash);
 }
 
 totemBool totemHashMap_TakeFrom(totemHashMap *hashmap, totemHashMap *from)
 {
     totemHashMap_Assert(hashmap);
     // todo: if this fails half-way through the list, free previously allocated entries
-    for(size_t i = 0; i < from->NumBuckets; i++)
+    size_t index = 0;
+    for (totemHashMapEntry *entry = totemHashMap_Iterate(from, &index); entry != NULL; entry = totemHashMap_Iterate(from, &index))
     {
-        totemHashMap_Assert(hashmap);
-        for(totemHashMapEntry *entry = from->Buckets[i]; entry != NULL; entry = entry->Next)
+        if(!totemHashMap_InsertPrecomputed(hashmap, entry->Key, entry->KeyLen, entry->Value, entry->Hash))
         {
-            totemHashMap_Assert(hashmap);
-            if(!totemHashMap_InsertPrecomputed(hashmap, entry->Key, entry->KeyLen, entry->Value, entry->Hash))
-            {
-                totemHashMap_Assert(hashmap);
-                return totemBool_False;
-            }
-            
-            totemHashMap_Assert(hashmap);
+            return totemBool_False;
         }
-        totemHashMap_Assert(hashmap);
     }
-    totemHashMap_Assert(hashmap);
     
+    totemHashMap_Assert(hashmap);
     return totemBool_True;
 }
 
-totemHashMapEntry *totemHashMap_RemovePrecomputed(totemHashMap *hashmap, const void *key, size_t keyLen, totemHash hash)
+static inline TOTEM_INLINE size_t totemHashMapTable_FindIndex(totemHashMapTable *table, const void *key, size_t keyLen, totemHash hash)
 {
-    totemHashMap_Assert(hashmap);
-    if (hashmap->NumBuckets > 0)
+    if (table->Capacity == 0)
+    {
+        return 0;
+    }
+    
+    size_t mask = table->Capacity - 1;
+    size_t pos = TOTEM_HASHMAP_H1(hash) & mask;
+    int8_t h2 = TOTEM_HASHMAP_H2(hash);
+    
+    for (size_t stride = TOTEM_HASHMAP_GROUPWIDTH; ; stride += TOTEM_HASHMAP_GROUPWIDTH)
     {
-        totemHashMap_Assert(hashmap);
-        int index = hash % hashmap->NumBuckets;
-        totemHashMap_Assert(hashmap);
-        for (totemHashMapEntry *entry = hashmap->Buckets[index], *prev = NULL; entry != NULL; prev = entry, entry = entry->Next)
+        const int8_t *group = table->Controls + pos;
+        
+        for (totemHashMapMask match = totemHashMap_MatchGroup(group, h2); match; match &= match - 1)
         {
-            totemHashMap_Assert(hashmap);
-            if (entry->Hash == hash && memcmp(entry->Key, key, keyLen) == 0)
+            size_t index = (pos + totemHashMapMask_LowestIndex(match)) & mask;
+            totemHashMapEntry *entry = table->Entries + index;
+            
+            if (entry->Hash == hash && entry->KeyLen == keyLen && memcmp(entry->Key, key, keyLen) == 0)
             {
-                totemHashMap_Assert(hashmap);
-                if (prev)
-                {
-                    totemHashMap_Assert(hashmap);
-                    prev->Next = entry->Next;
-                    totemHashMap_Assert(hashmap);
-                }
-                else
-                {
-                    totemHashMap_Assert(hashmap);
-                    hashmap->Buckets[index] = entry->Next;
-                    totemHashMap_Assert(hashmap);
-                }
-                
-                totemHashMap_Assert(hashmap);
-                totemHashMap_FreeEntry(hashmap, entry);
-                totemHashMap_Assert(hashmap);
-                hashmap->NumKeys--;
-                return entry;
+                return index;
             }
-            totemHashMap_Assert(hashmap);
         }
-        totemHashMap_Assert(hashmap);
+        
+        // the key would have been placed in the first empty slot along its probe sequence
+        if (totemHashMap_MatchEmpty(group))
+        {
+            return table->Capacity;
+        }
+        
+        pos = (pos + stride) & mask;
+    }
+}
+
+// while migrating, a key lives in exactly one of the two tables
+static inline TOTEM_INLINE totemHashMapTable *totemHashMap_FindTable(totemHashMap *hashmap, const void *key, size_t keyLen, totemHash hash, size_t *indexOut)
+{
+    if (hashmap->NumKeys == 0)
+    {
+        return NULL;
+    }
+    
+    size_t index = totemHashMapTable_FindIndex(&hashmap->Table, key, keyLen, hash);
+    if (index < hashmap->Table.Capacity)
+    {
+        *indexOut = index;
+        return &hashmap->Table;
+    }
+    
+    if (hashmap->Old.Capacity)
+    {
+        index = totemHashMapTable_FindIndex(&hashmap->Old, key, keyLen, hash);
+        if (index < hashmap->Old.Capacity)
+        {
+            *indexOut = index;
+            return &hashmap->Old;
+        }
     }
     
-    totemHashMap_Assert(hashmap);
     return NULL;
 }
 
-totemHashMapEntry *totemHashMap_Remove(totemHashMap *hashmap, const void *key, size_t keyLen)
+totemHashMapEntry *totemHashMap_RemovePrecomputed(totemHashMap *hashmap, const void *key, size_t keyLen, totemHash hash)
 {
     totemHashMap_Assert(hashmap);
-    totemHash hash = totem_Hash(key, keyLen);
+    size_t index = 0;
+    totemHashMapTable *table = totemHashMap_FindTable(hashmap, key, keyLen, hash, &index);
+    if (!table)
+    {
+        return NULL;
+    }
+    
+    // slot is left as a tombstone, so the entry's value stays readable until the next insert
+    totemHashMap_FreeEntry(hashmap, table, index);
+    hashmap->NumKeys--;
     totemHashMap_Assert(hashmap);
-    totemHashMapEntry *result = totemHashMap_RemovePrecomputed(hashmap, key, keyLen, hash);
+    return table->Entries + index;
+}
+
+totemHashMapEntry *totemHashMap_Remove(totemHashMap *hashmap, const void *key, size_t keyLen)
+{
     totemHashMap_Assert(hashmap);
-    return result;
+    totemHash hash = totem_Hash(key, keyLen);
+    return totemHashMap_RemovePrecomputed(hashmap, key, keyLen, hash);
 }
 
 totemHashMapEntry *totemHashMap_Find(totemHashMap *hashmap, const void *key, size_t keyLen)
 {
     totemHashMap_Assert(hashmap);
     totemHash hash = totem_Hash(key, keyLen);
-    totemHashMap_Assert(hashmap);
-    totemHashMapEntry *result = totemHashMap_FindPrecomputed(hashmap, key, keyLen, hash);
-    totemHashMap_Assert(hashmap);
-    return result;
+    return totemHashMap_FindPrecomputed(hashmap, key, keyLen, hash);
 }
 
 totemHashMapEntry *totemHashMap_FindPrecomputed(totemHashMap *hashmap, const void *key, size_t keyLen, totemHash hash)
 {
     totemHashMap_Assert(hashmap);
-    if(hashmap->NumBuckets > 0)
+    size_t index = 0;
+    totemHashMapTable *table = totemHashMap_FindTable(hashmap, key, keyLen, hash, &index);
+    if (!table)
+    {
+        return NULL;
+    }
+    
+    return table->Entries + index;
+}
+
+totemHashMapEntry *totemHashMap_Iterate(totemHashMap *hashmap, size_t *index)
+{
+    // current table first, then whatever is still waiting to be migrated
+    size_t total = hashmap->Table.Capacity + hashmap->Old.Capacity;
+    
+    for (size_t i = *index; i < total; i++)
+    {
+        totemHashMapTable *table = &hashmap->Table;
+        size_t slot = i;
+        
+        if (slot >= table->Capacity)
+        {
+            slot -= table->Capacity;
+            table = &hashmap->Old;
+        }
+        
+        if (table->Controls[slot] >= 0)
+        {
+            *index = i + 1;
+            return table->Entries + slot;
+        }
+    }
+    
+    *index = total;
+    return NULL;
+}
+
+static void totemHashMapTable_FreeKeys(totemHashMap *hashmap, totemHashMapTable *table, totemBool pushValues)
+{
+    for (size_t i = 0; i < table->Capacity; i++)
     {
-        totemHashMap_Assert(hashmap);
-        int index = hash % hashmap->NumBuckets;
-        totemHashMap_Assert(hashmap);
-        for(totemHashMapEntry *entry = hashmap->Buckets[index]; entry != NULL; entry = entry->Next)
+        if (table->Controls[i] >= 0)
         {
-            totemHashMap_Assert(hashmap);
+            totemHashMapEntry *entry = table->Entries + i;
+            totemHashMap_FreeKey(hashmap, entry);
             
-            if(entry->Hash == hash && entry->KeyLen == keyLen && memcmp(entry->Key, key, entry->KeyLen) == 0)
+            if (pushValues)
             {
-                totemHashMap_Assert(hashmap);
-                return entry;
+                totemHashMap_PushFreeValue(hashmap, entry->Value);
             }
-            totemHashMap_Assert(hashmap);
         }
     }
-    
-    totemHashMap_Assert(hashmap);
-    return NULL;
 }
 
 void totemHashMap_Reset(totemHashMap *hashmap)
 {
     totemHashMap_Assert(hashmap);
-    totemHashMap_MoveKeysToFreeList(hashmap);
-    totemHashMap_Assert(hashmap);
+    
+    totemHashMapTable_FreeKeys(hashmap, &hashmap->Table, totemBool_True);
+    totemHashMapTable_FreeKeys(hashmap, &hashmap->Old, totemBool_True);
+    totemHashMap_FreeTable(hashmap, &hashmap->Old);
+    hashmap->MigrateIndex = 0;
+    
+    totemHashMapTable *table = &hashmap->Table;
+    if (table->Capacity)
+    {
+        memset(table->Controls, TOTEM_HASHMAP_CONTROL_EMPTY, table->Capacity + TOTEM_HASHMAP_GROUPWIDTH);
+        table->GrowthLeft = TOTEM_HASHMAP_MAXLOAD(table->Capacity);
+    }
+    
     hashmap->NumKeys = 0;
     totemHashMap_Assert(hashmap);
 }
@@ -782,20 +2191,18 @@ void totemHashMap_Reset(totemHashMap *hashmap)
 void totemHashMap_Cleanup(totemHashMap *map)
 {
     totemHashMap_Assert(map);
-    totemHashMap_MoveKeysToFreeList(map);
-    totemHashMap_Assert(map);
-    while(map->FreeList)
+    
+    totemHashMapTable_FreeKeys(map, &map->Table, totemBool_False);
+    totemHashMapTable_FreeKeys(map, &map->Old, totemBool_False);
+    totemHashMap_FreeTable(map, &map->Table);
+    totemHashMap_FreeTable(map, &map->Old);
+    
+    if (map->FreeValues)
     {
-        totemHashMap_Assert(map);
-        totemHashMapEntry *entry = map->FreeList;
-        map->FreeList = entry->Next;
-        totem_CacheFree(entry, sizeof(totemHashMapEntry));
-        totemHashMap_Assert(map);
+        totemHashMap_Free(map, map->FreeValues, sizeof(totemHashValue) * map->MaxFreeValues);
     }
     
-    totemHashMap_Assert(map);
-    totem_CacheFree(map->Buckets, sizeof(totemHashMapEntry**) * map->NumBuckets);
-    map->Buckets = NULL;
-    map->NumBuckets = 0;
-    totemHashMap_Assert(map);
-}
\ No newline at end of file
+    totemAllocator *allocator = map->Allocator;
+    totemHashMap_Init(map);
+    map->Allocator = allocator;
+}
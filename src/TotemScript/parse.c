@@ -137,6 +137,13 @@ totemParseStatus totemBlockPrototype_Parse(totemBlockPrototype *block, totemPars
             return totemFunctionDeclarationPrototype_Parse(block->FuncDec, tree, totemBool_False);
         }
             
+        case totemTokenType_Struct:
+        {
+            block->Type = totemBlockType_StructDeclaration;
+            TOTEM_PARSE_ALLOC(block->StructDec, totemStructDeclarationPrototype, tree);
+            return totemStructDeclarationPrototype_Parse(block->StructDec, tree);
+        }
+            
         default:
         {
             block->Type = totemBlockType_Statement;
@@ -184,6 +191,15 @@ totemParseStatus totemStatementPrototype_Parse(totemStatementPrototype *statemen
             break;
         }
             
+        case totemTokenType_ForEach:
+        {
+            statement->Type = totemStatementType_ForEachLoop;
+            TOTEM_PARSE_ALLOC(statement->ForEachLoop, totemForEachLoopPrototype, tree);
+            status = totemForEachLoopPrototype_Parse(statement->ForEachLoop, tree);
+            TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+            break;
+        }
+            
         case totemTokenType_If:
         {
             statement->Type = totemStatementType_IfBlock;
@@ -505,6 +521,57 @@ totemParseStatus totemForLoopPrototype_Parse(totemForLoopPrototype *loop, totemP
     return totemParseStatus_Success;
 }
 
+totemParseStatus totemForEachLoopPrototype_Parse(totemForEachLoopPrototype *loop, totemParseTree *tree)
+{
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    TOTEM_PARSE_COPYPOSITION(tree->CurrentToken, loop);
+    TOTEM_PARSE_ENFORCETOKEN(tree, tree->CurrentToken, totemTokenType_ForEach);
+    TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    
+    if(tree->CurrentToken->Type == totemTokenType_LBracket)
+    {
+        TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+        TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    }
+    
+    TOTEM_PARSE_ALLOC(loop->Value, totemVariablePrototype, tree);
+    TOTEM_PARSE_COPYPOSITION(tree->CurrentToken, loop->Value);
+    TOTEM_PARSE_CHECKRETURN(totemString_ParseIdentifier(&loop->Value->Identifier, tree, totemBool_True));
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    
+    // with two variables, the first is the key
+    if(tree->CurrentToken->Type == totemTokenType_Comma)
+    {
+        TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+        TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+        
+        loop->Key = loop->Value;
+        TOTEM_PARSE_ALLOC(loop->Value, totemVariablePrototype, tree);
+        TOTEM_PARSE_COPYPOSITION(tree->CurrentToken, loop->Value);
+        TOTEM_PARSE_CHECKRETURN(totemString_ParseIdentifier(&loop->Value->Identifier, tree, totemBool_True));
+        TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    }
+    
+    TOTEM_PARSE_ENFORCETOKEN(tree, tree->CurrentToken, totemTokenType_In);
+    TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+    
+    TOTEM_PARSE_ALLOC(loop->Collection, totemExpressionPrototype, tree);
+    TOTEM_PARSE_CHECKRETURN(totemExpressionPrototype_Parse(loop->Collection, tree));
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    
+    if(tree->CurrentToken->Type == totemTokenType_RBracket)
+    {
+        TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+    }
+    
+    totemStatementPrototype *firstStatement = NULL, *lastStatement = NULL;
+    TOTEM_PARSE_CHECKRETURN(totemStatementPrototype_ParseSet(&firstStatement, &lastStatement, tree));
+    loop->StatementsStart = firstStatement;
+    
+    return totemParseStatus_Success;
+}
+
 totemParseStatus totemFunctionDeclarationPrototype_Parse(totemFunctionDeclarationPrototype *func, totemParseTree *tree, totemBool isAnonymous)
 {
     TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
@@ -533,6 +600,62 @@ totemParseStatus totemFunctionDeclarationPrototype_Parse(totemFunctionDeclaratio
     return totemParseStatus_Success;
 }
 
+totemParseStatus totemStructDeclarationPrototype_Parse(totemStructDeclarationPrototype *dec, totemParseTree *tree)
+{
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    TOTEM_PARSE_ENFORCETOKEN(tree, tree->CurrentToken, totemTokenType_Struct);
+    TOTEM_PARSE_COPYPOSITION(tree->CurrentToken, dec);
+    
+    TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    
+    TOTEM_PARSE_ALLOC(dec->Identifier, totemString, tree);
+    TOTEM_PARSE_CHECKRETURN(totemString_ParseIdentifier(dec->Identifier, tree, totemBool_True));
+    
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    TOTEM_PARSE_ENFORCETOKEN(tree, tree->CurrentToken, totemTokenType_LCBracket);
+    TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+    TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    
+    // fields
+    totemVariablePrototype *lastField = NULL;
+    do
+    {
+        totemVariablePrototype *field = NULL;
+        TOTEM_PARSE_ALLOC(field, totemVariablePrototype, tree);
+        TOTEM_PARSE_COPYPOSITION(tree->CurrentToken, field);
+        TOTEM_PARSE_CHECKRETURN(totemString_ParseIdentifier(&field->Identifier, tree, totemBool_True));
+        TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+        
+        if (lastField)
+        {
+            lastField->Next = field;
+        }
+        else
+        {
+            dec->FieldsStart = field;
+        }
+        
+        lastField = field;
+        dec->NumFields++;
+        
+        if (tree->CurrentToken->Type == totemTokenType_Comma)
+        {
+            TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+            TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+            TOTEM_PARSE_ENFORCENOTTOKEN(tree, tree->CurrentToken, totemTokenType_RCBracket);
+        }
+        else
+        {
+            TOTEM_PARSE_ENFORCETOKEN(tree, tree->CurrentToken, totemTokenType_RCBracket);
+        }
+    }
+    while (tree->CurrentToken->Type != totemTokenType_RCBracket);
+    
+    tree->CurrentToken++;
+    return totemParseStatus_Success;
+}
+
 totemParseStatus totemExpressionPrototype_ParseSub(totemExpressionPrototype *expression, totemParseTree *tree, int priority)
 {
     TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
@@ -960,6 +1083,15 @@ totemParseStatus totemVariablePrototype_Parse(totemVariablePrototype *variable,
     TOTEM_PARSE_CHECKRETURN(totemString_ParseIdentifier(&variable->Identifier, tree, totemBool_False));
     TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
     
+    // struct the variable holds
+    if (tree->CurrentToken->Type == totemTokenType_Colon)
+    {
+        TOTEM_PARSE_INC_NOT_ENDSCRIPT(tree, tree->CurrentToken);
+        TOTEM_PARSE_ALLOC(variable->Struct, totemString, tree);
+        TOTEM_PARSE_CHECKRETURN(totemString_ParseIdentifier(variable->Struct, tree, totemBool_True));
+        TOTEM_PARSE_SKIPWHITESPACE(tree->CurrentToken);
+    }
+    
     return totemParseStatus_Success;
 }
 
@@ -49,6 +49,8 @@ static totemTokenDesc s_reservedWordValues[] =
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Do, "do"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_While, "while"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_For, "for"),
+    TOTEM_DESC_TOKEN_WORD(totemTokenType_ForEach, "foreach"),
+    TOTEM_DESC_TOKEN_WORD(totemTokenType_In, "in"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Return, "return"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Case, "case"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Break, "break"),
@@ -70,6 +72,7 @@ static totemTokenDesc s_reservedWordValues[] =
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Coroutine, "coroutine"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Object, "object"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Userdata, "userdata"),
+    TOTEM_DESC_TOKEN_WORD(totemTokenType_Struct, "struct"),
     TOTEM_DESC_TOKEN_WORD(totemTokenType_Var, "var")
 };
 
@@ -473,9 +476,11 @@ const char *totemTokenType_Describe(totemTokenType type)
             TOTEM_STRINGIFY_CASE(totemTokenType_EndScript);
             TOTEM_STRINGIFY_CASE(totemTokenType_False);
             TOTEM_STRINGIFY_CASE(totemTokenType_For);
+            TOTEM_STRINGIFY_CASE(totemTokenType_ForEach);
             TOTEM_STRINGIFY_CASE(totemTokenType_Function);
             TOTEM_STRINGIFY_CASE(totemTokenType_Identifier);
             TOTEM_STRINGIFY_CASE(totemTokenType_If);
+            TOTEM_STRINGIFY_CASE(totemTokenType_In);
             TOTEM_STRINGIFY_CASE(totemTokenType_Is);
             TOTEM_STRINGIFY_CASE(totemTokenType_LBracket);
             TOTEM_STRINGIFY_CASE(totemTokenType_LCBracket);
@@ -499,6 +504,7 @@ const char *totemTokenType_Describe(totemTokenType type)
             TOTEM_STRINGIFY_CASE(totemTokenType_Semicolon);
             TOTEM_STRINGIFY_CASE(totemTokenType_SingleQuote);
             TOTEM_STRINGIFY_CASE(totemTokenType_Slash);
+            TOTEM_STRINGIFY_CASE(totemTokenType_Struct);
             TOTEM_STRINGIFY_CASE(totemTokenType_True);
             TOTEM_STRINGIFY_CASE(totemTokenType_Userdata);
             TOTEM_STRINGIFY_CASE(totemTokenType_While);
@@ -12,14 +12,135 @@
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
+#include <math.h>
+
+#if defined(TOTEM_MSC) && defined(TOTEM_X64)
+#include <intrin.h>
+#endif
 
 static totemHashCb hashCb = NULL;
 
-void totem_SetGlobalCallbacks(totemHashCb newHashCb)
+void totem_SetHashCallback(totemHashCb newHashCb)
 {
     hashCb = newHashCb;
 }
 
+/*
+ wyhash-style hash
+ - reads the key 8 bytes at a time & mixes with 64x64->128-bit multiplies
+ - keys longer than 48 bytes are consumed by 3 independent lanes so the multiplies can overlap
+ - short keys (identifiers, object keys) take a single branch and two multiplies
+ */
+#define TOTEM_HASH_SECRET0 (0xa0761d6478bd642full)
+#define TOTEM_HASH_SECRET1 (0xe7037ed1a0b428dbull)
+#define TOTEM_HASH_SECRET2 (0x8ebc6af09c88c6e3ull)
+#define TOTEM_HASH_SECRET3 (0x589965cc75374cc3ull)
+
+static void totem_HashMultiply(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(TOTEM_MSC) && defined(TOTEM_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static uint64_t totem_HashMix(uint64_t a, uint64_t b)
+{
+    totem_HashMultiply(&a, &b);
+    return a ^ b;
+}
+
+static uint64_t totem_HashRead8(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t totem_HashRead4(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+totemHash totem_DefaultHash(const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    uint64_t seed = totem_HashMix(TOTEM_HASH_SECRET0, TOTEM_HASH_SECRET1);
+    uint64_t a, b;
+    
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            // two overlapping reads from each end cover every byte
+            size_t mid = (len >> 3) << 2;
+            a = (totem_HashRead4(p) << 32) | totem_HashRead4(p + mid);
+            b = (totem_HashRead4(p + len - 4) << 32) | totem_HashRead4(p + len - 4 - mid);
+        }
+        else if (len > 0)
+        {
+            a = (((uint64_t)p[0]) << 16) | (((uint64_t)p[len >> 1]) << 8) | p[len - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t i = len;
+        
+        if (i > 48)
+        {
+            uint64_t see1 = seed, see2 = seed;
+            
+            do
+            {
+                seed = totem_HashMix(totem_HashRead8(p) ^ TOTEM_HASH_SECRET1, totem_HashRead8(p + 8) ^ seed);
+                see1 = totem_HashMix(totem_HashRead8(p + 16) ^ TOTEM_HASH_SECRET2, totem_HashRead8(p + 24) ^ see1);
+                see2 = totem_HashMix(totem_HashRead8(p + 32) ^ TOTEM_HASH_SECRET3, totem_HashRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }
+            while (i > 48);
+            
+            seed ^= see1 ^ see2;
+        }
+        
+        while (i > 16)
+        {
+            seed = totem_HashMix(totem_HashRead8(p) ^ TOTEM_HASH_SECRET1, totem_HashRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        
+        a = totem_HashRead8(p + i - 16);
+        b = totem_HashRead8(p + i - 8);
+    }
+    
+    a ^= TOTEM_HASH_SECRET1;
+    b ^= seed;
+    totem_HashMultiply(&a, &b);
+    
+    uint64_t h = totem_HashMix(a ^ TOTEM_HASH_SECRET0 ^ len, b ^ TOTEM_HASH_SECRET1);
+    return (totemHash)(h ^ (h >> 32));
+}
+
 totemHash totem_Hash(const void *data, size_t len)
 {
     if(hashCb)
@@ -27,15 +148,380 @@ totemHash totem_Hash(const void *data, size_t len)
         return hashCb(data, len);
     }
     
-    const char *ptr = data;
+    return totem_DefaultHash(data, len);
+}
+
+static const char totem_DigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+size_t totem_IntToChars(char *buffer, int64_t val)
+{
+    char digits[TOTEM_INTCHARS_MAXLENGTH];
+    char *end = digits + TOTEM_ARRAY_SIZE(digits);
+    char *start = end;
+    
+    uint64_t abs = val < 0 ? 0 - (uint64_t)val : (uint64_t)val;
+    
+    // two digits per divide, back to front
+    while (abs >= 100)
+    {
+        size_t pair = (size_t)(abs % 100) * 2;
+        abs /= 100;
+        *--start = totem_DigitPairs[pair + 1];
+        *--start = totem_DigitPairs[pair];
+    }
+    
+    if (abs >= 10)
+    {
+        size_t pair = (size_t)abs * 2;
+        *--start = totem_DigitPairs[pair + 1];
+        *--start = totem_DigitPairs[pair];
+    }
+    else
+    {
+        *--start = (char)('0' + abs);
+    }
+    
+    if (val < 0)
+    {
+        *--start = '-';
+    }
+    
+    size_t len = (size_t)(end - start);
+    memcpy(buffer, start, len);
+    return len;
+}
+
+/*
+ Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers")
+ - scales the double & its rounding boundaries by a cached power of ten into 64-bit fixed point
+ - emits digits until the result is inside the boundaries, so it always reads back as the same double
+ - almost always the shortest such string, and never more than 17 digits
+ */
+typedef struct
+{
+    uint64_t F;
+    int E;
+}
+totemDiyFp;
+
+#define TOTEM_DOUBLE_SIGNIFICANDBITS (52)
+#define TOTEM_DOUBLE_HIDDENBIT (UINT64_C(1) << TOTEM_DOUBLE_SIGNIFICANDBITS)
+#define TOTEM_DOUBLE_EXPONENTBIAS (0x3FF + TOTEM_DOUBLE_SIGNIFICANDBITS)
+
+// 10^k for k = -348, -340 ... 340, normalised so the top bit is set
+static const uint64_t totem_CachedPowersF[] =
+{
+    UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76),
+    UINT64_C(0xcf42894a5dce35ea), UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+    UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f), UINT64_C(0xbe5691ef416bd60c),
+    UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+    UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57),
+    UINT64_C(0xc21094364dfb5637), UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+    UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5), UINT64_C(0xb23867fb2a35b28e),
+    UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+    UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126),
+    UINT64_C(0xb5b5ada8aaff80b8), UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+    UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd), UINT64_C(0xa6dfbd9fb8e5b88f),
+    UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+    UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06),
+    UINT64_C(0xaa242499697392d3), UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+    UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c), UINT64_C(0x9c40000000000000),
+    UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+    UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068),
+    UINT64_C(0x9f4f2726179a2245), UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+    UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a), UINT64_C(0x924d692ca61be758),
+    UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+    UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d),
+    UINT64_C(0x952ab45cfa97a0b3), UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+    UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece), UINT64_C(0x88fcf317f22241e2),
+    UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+    UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410),
+    UINT64_C(0x8bab8eefb6409c1a), UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+    UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429), UINT64_C(0x80444b5e7aa7cf85),
+    UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+    UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b)
+};
+
+static const int16_t totem_CachedPowersE[] =
+{
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+static const uint32_t totem_Pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static totemDiyFp totemDiyFp_Multiply(totemDiyFp a, totemDiyFp b)
+{
+    uint64_t lo = a.F;
+    uint64_t hi = b.F;
+    totem_HashMultiply(&lo, &hi);
+    
+    totemDiyFp result;
+    result.F = hi + (lo >> 63);
+    result.E = a.E + b.E + 64;
+    return result;
+}
+
+static totemDiyFp totemDiyFp_Normalize(totemDiyFp fp, int topBit)
+{
+    while (!(fp.F & (UINT64_C(1) << topBit)))
+    {
+        fp.F <<= 1;
+        fp.E--;
+    }
+    
+    fp.F <<= 63 - topBit;
+    fp.E -= 63 - topBit;
+    return fp;
+}
+
+static totemDiyFp totemDiyFp_GetCachedPower(int e, int *k)
+{
+    // smallest power of ten that brings the product's exponent to -60ish
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int index = (int)dk;
+    if (dk - index > 0.0)
+    {
+        index++;
+    }
+    
+    index = (index >> 3) + 1;
+    *k = -(-348 + (index << 3));
+    
+    totemDiyFp result;
+    result.F = totem_CachedPowersF[index];
+    result.E = totem_CachedPowersE[index];
+    return result;
+}
+
+static void totem_GrisuRound(char *buffer, int len, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    // step the last digit down while that gets closer to the real value & stays within the boundaries
+    while (rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+    {
+        buffer[len - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static int totem_CountDigits(uint32_t val)
+{
+    int count = 1;
+    while (count < 10 && val >= totem_Pow10[count])
+    {
+        count++;
+    }
+    
+    return count;
+}
+
+static int totem_GrisuDigits(totemDiyFp w, totemDiyFp upper, uint64_t delta, char *buffer, int *k)
+{
+    totemDiyFp one;
+    one.E = upper.E;
+    one.F = UINT64_C(1) << -one.E;
+    
+    uint64_t distance = upper.F - w.F;
+    uint32_t integral = (uint32_t)(upper.F >> -one.E);
+    uint64_t fractional = upper.F & (one.F - 1);
+    int kappa = totem_CountDigits(integral);
+    int len = 0;
+    
+    while (kappa > 0)
+    {
+        uint32_t digit = integral / totem_Pow10[kappa - 1];
+        integral %= totem_Pow10[kappa - 1];
+        
+        if (digit || len)
+        {
+            buffer[len++] = (char)('0' + digit);
+        }
+        
+        kappa--;
+        
+        uint64_t rest = ((uint64_t)integral << -one.E) + fractional;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            totem_GrisuRound(buffer, len, delta, rest, (uint64_t)totem_Pow10[kappa] << -one.E, distance);
+            return len;
+        }
+    }
+    
+    for (;;)
+    {
+        fractional *= 10;
+        delta *= 10;
+        
+        char digit = (char)(fractional >> -one.E);
+        if (digit || len)
+        {
+            buffer[len++] = (char)('0' + digit);
+        }
+        
+        fractional &= one.F - 1;
+        kappa--;
+        
+        if (fractional < delta)
+        {
+            *k += kappa;
+            totem_GrisuRound(buffer, len, delta, fractional, one.F, -kappa < 10 ? distance * totem_Pow10[-kappa] : 0);
+            return len;
+        }
+    }
+}
+
+// digits for a positive, finite, non-zero value, which is digits * 10^k
+static int totem_Grisu2(double val, char *buffer, int *k)
+{
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    
+    uint64_t biasedExponent = (bits >> TOTEM_DOUBLE_SIGNIFICANDBITS) & 0x7FF;
+    
+    totemDiyFp v;
+    v.F = bits & (TOTEM_DOUBLE_HIDDENBIT - 1);
+    
+    if (biasedExponent)
+    {
+        v.F += TOTEM_DOUBLE_HIDDENBIT;
+        v.E = (int)biasedExponent - TOTEM_DOUBLE_EXPONENTBIAS;
+    }
+    else
+    {
+        // subnormal
+        v.E = 1 - TOTEM_DOUBLE_EXPONENTBIAS;
+    }
+    
+    // halfway to the neighbouring doubles either side, the lower one is closer when v is a power of two
+    totemDiyFp upper;
+    upper.F = (v.F << 1) + 1;
+    upper.E = v.E - 1;
+    upper = totemDiyFp_Normalize(upper, TOTEM_DOUBLE_SIGNIFICANDBITS + 1);
+    
+    totemDiyFp lower;
+    if (v.F == TOTEM_DOUBLE_HIDDENBIT)
+    {
+        lower.F = (v.F << 2) - 1;
+        lower.E = v.E - 2;
+    }
+    else
+    {
+        lower.F = (v.F << 1) - 1;
+        lower.E = v.E - 1;
+    }
+    
+    lower.F <<= lower.E - upper.E;
+    lower.E = upper.E;
+    
+    totemDiyFp cachedPower = totemDiyFp_GetCachedPower(upper.E, k);
+    totemDiyFp w = totemDiyFp_Multiply(totemDiyFp_Normalize(v, 63), cachedPower);
+    totemDiyFp scaledUpper = totemDiyFp_Multiply(upper, cachedPower);
+    totemDiyFp scaledLower = totemDiyFp_Multiply(lower, cachedPower);
+    
+    // stay clear of the boundaries themselves, they may have been rounded either way
+    scaledUpper.F--;
+    scaledLower.F++;
     
-    totemHash hash = 5831;
-    for(uint32_t i = 0; i < len; ++i)
+    return totem_GrisuDigits(w, scaledUpper, scaledUpper.F - scaledLower.F, buffer, k);
+}
+
+size_t totem_FloatToChars(char *buffer, double val)
+{
+    char *out = buffer;
+    
+    if (val != val)
     {
-        hash = 33 * hash + ptr[i];
+        memcpy(out, "nan", 3);
+        return 3;
     }
     
-    return hash;
+    if (signbit(val))
+    {
+        *out++ = '-';
+        val = -val;
+    }
+    
+    if (isinf(val))
+    {
+        memcpy(out, "inf", 3);
+        return (size_t)(out - buffer) + 3;
+    }
+    
+    if (val == 0)
+    {
+        *out++ = '0';
+        return (size_t)(out - buffer);
+    }
+    
+    char digits[18];
+    int k = 0;
+    int len = totem_Grisu2(val, digits, &k);
+    
+    // exponent of the first digit, as in d.ddd * 10^exp
+    int exp = len + k - 1;
+    
+    if (exp >= -6 && exp < 21)
+    {
+        if (k >= 0)
+        {
+            // integral
+            memcpy(out, digits, (size_t)len);
+            out += len;
+            memset(out, '0', (size_t)k);
+            out += k;
+        }
+        else if (exp >= 0)
+        {
+            memcpy(out, digits, (size_t)(exp + 1));
+            out += exp + 1;
+            *out++ = '.';
+            memcpy(out, digits + exp + 1, (size_t)(len - exp - 1));
+            out += len - exp - 1;
+        }
+        else
+        {
+            *out++ = '0';
+            *out++ = '.';
+            memset(out, '0', (size_t)(-exp - 1));
+            out += -exp - 1;
+            memcpy(out, digits, (size_t)len);
+            out += len;
+        }
+    }
+    else
+    {
+        *out++ = digits[0];
+        
+        if (len > 1)
+        {
+            *out++ = '.';
+            memcpy(out, digits + 1, (size_t)(len - 1));
+            out += len - 1;
+        }
+        
+        *out++ = 'e';
+        *out++ = exp < 0 ? '-' : '+';
+        out += totem_IntToChars(out, exp < 0 ? -exp : exp);
+    }
+    
+    return (size_t)(out - buffer);
 }
 
 void totemString_FromLiteral(totemString *strOut, const char *str)
@@ -72,6 +558,7 @@ const char *totemOperationType_Describe(totemOperationType op)
             TOTEM_STRINGIFY_CASE(totemOperationType_MoreThan);
             TOTEM_STRINGIFY_CASE(totemOperationType_MoreThanEquals);
             TOTEM_STRINGIFY_CASE(totemOperationType_Move);
+            TOTEM_STRINGIFY_CASE(totemOperationType_Next);
             TOTEM_STRINGIFY_CASE(totemOperationType_Multiply);
             TOTEM_STRINGIFY_CASE(totemOperationType_NewObject);
             TOTEM_STRINGIFY_CASE(totemOperationType_NotEquals);
@@ -87,6 +574,7 @@ const char *totemOperationType_Describe(totemOperationType op)
             TOTEM_STRINGIFY_CASE(totemOperationType_As);
             TOTEM_STRINGIFY_CASE(totemOperationType_Is);
             TOTEM_STRINGIFY_CASE(totemOperationType_ComplexShift);
+            TOTEM_STRINGIFY_CASE(totemOperationType_CheckStruct);
     }
     
     return "UNKNOWN";
@@ -128,6 +616,8 @@ const char *totemPrivateDataType_Describe(totemPrivateDataType type)
             TOTEM_STRINGIFY_CASE(totemPrivateDataType_Userdata);
             TOTEM_STRINGIFY_CASE(totemPrivateDataType_Null);
             TOTEM_STRINGIFY_CASE(totemPrivateDataType_Boolean);
+            TOTEM_STRINGIFY_CASE(totemPrivateDataType_Rope);
+            TOTEM_STRINGIFY_CASE(totemPrivateDataType_TypedArray);
         default: return "UNKNOWN";
     }
 }
@@ -143,6 +633,7 @@ totemInstructionType totemOperationType_GetInstructionType(totemOperationType op
         case totemOperationType_MoveToLocal:
         case totemOperationType_PreInvoke:
         case totemOperationType_Invoke:
+        case totemOperationType_CheckStruct:
             return totemInstructionType_Abx;
             
         case totemOperationType_Goto:
@@ -158,6 +649,12 @@ void totemInstruction_PrintList(FILE *file, totemInstruction *instructions, size
     for(size_t i = 0; i < num; ++i)
     {
         totemInstruction_Print(file, instructions[i]);
+        
+        // Next is followed by a word that's never dispatched, holding its key register & the offset to the end of the loop
+        if (TOTEM_INSTRUCTION_GET_OP(instructions[i]) == totemOperationType_Next && i + 1 < num)
+        {
+            totemInstruction_PrintNextExtension(file, instructions[++i]);
+        }
     }
 }
 
@@ -227,6 +724,16 @@ void totemInstruction_PrintAbxInstruction(FILE *file, totemInstruction instructi
             TOTEM_INSTRUCTION_GET_BX_UNSIGNED(instruction));
 }
 
+void totemInstruction_PrintNextExtension(FILE *file, totemInstruction instruction)
+{
+    fprintf(file, "%08x (extends %s) a:%c%d bx:%d\n",
+            instruction,
+            totemOperationType_Describe(totemOperationType_Next),
+            totemOperandType_GetChar(TOTEM_INSTRUCTION_GET_REGISTERA_SCOPE(instruction)),
+            TOTEM_INSTRUCTION_GET_REGISTERA_INDEX(instruction),
+            TOTEM_INSTRUCTION_GET_BX_SIGNED(instruction));
+}
+
 void totemInstruction_PrintAxxInstruction(FILE *file, totemInstruction instruction)
 {
     fprintf(file, "%08x %s ax:%08x\n",
@@ -330,7 +837,7 @@ totemBool totem_getcwd(char *buffer, size_t size)
 void totem_Init()
 {
 #define TOTEM_OPCODE_FORMAT(x) 0,
-    TOTEM_STATIC_ASSERT(TOTEM_ARRAY_SIZE((int[]){TOTEM_EMIT_OPCODES()}) < TOTEM_MAXVAL_UNSIGNED(size_t, totemInstructionSize_Op), "Too many opcodes defined!");
+    TOTEM_STATIC_ASSERT(TOTEM_ARRAY_SIZE((int[]){TOTEM_EMIT_OPCODES()}) <= TOTEM_MAXVAL_UNSIGNED(size_t, totemInstructionSize_Op), "Too many opcodes defined!");
 #undef TOTEM_OPCODE_FORMAT
     
     TOTEM_STATIC_ASSERT(TOTEM_STRING_LITERAL_SIZE("test") == 4, "String length test");
@@ -25,6 +25,7 @@ const char *const help = "usage: TotemScriptCmd [options] [filename|string]\n"
 "-s / --string		Parse \"string\"\n"
 "-d / --dump		Display bytecode before running\n"
 "-p / --norun		Only parse bytecode\n"
+"-m / --mem-stats	Display allocator statistics on exit\n"
 "\n"
 "http://github.com/tdsmale/TotemScript/\n";
 
@@ -118,6 +119,7 @@ int main(int argc, const char **argv)
     totemBool doString = totemBool_False;
     totemBool dumpInstructions = totemBool_False;
     totemBool doNotRun = totemBool_False;
+    totemBool memStats = totemBool_False;
     
     if (argc <= 1)
     {
@@ -153,6 +155,10 @@ int main(int argc, const char **argv)
         {
             doNotRun = totemBool_True;
         }
+        else if (TOTEM_CMD_ISARG("--mem-stats", arg) || TOTEM_CMD_ISARG("-m", arg))
+        {
+            memStats = totemBool_True;
+        }
         else
         {
             toParse = arg;
@@ -215,7 +221,25 @@ int main(int argc, const char **argv)
             }
         }
         
+        if (memStats)
+        {
+            fprintf(stderr, "******\n");
+            fprintf(stderr, "Memory:\n");
+            fprintf(stderr, "******\n");
+            size_t runtimeBytes = 0, runtimePeakBytes = 0;
+            totemRuntime_GetMemoryUsage(&state.Runtime, &runtimeBytes, &runtimePeakBytes);
+            fprintf(stderr, "exec state: %zu peak bytes, runtime: %zu bytes, %zu peak bytes\n", state.ExecState.Allocator.PeakBytes, runtimeBytes, runtimePeakBytes);
+        }
+        
         totemCmdState_Cleanup(&state);
+        
+        if (memStats)
+        {
+            // anything still live once everything has been cleaned up is a leak
+            totem_FlushThreadCache();
+            totem_PrintMemoryStats(stderr);
+        }
+        
         totem_Cleanup();
     }
     else
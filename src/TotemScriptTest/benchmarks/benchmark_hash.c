@@ -0,0 +1,232 @@
+//
+//  benchmark_hash.c
+//  TotemScriptTest
+//
+//  Compares totem_DefaultHash against the previous 33 * hash + c hash
+//  - throughput on short identifier-like keys & longer url-like keys
+//  - distribution as totemHashMap sees it: the H1 probe start masked to a power-of-two capacity,
+//    & the 7-bit H2 control byte that filters key compares within a probe group
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <TotemScript/totem.h>
+
+#define TOTEM_BENCH_NUMKEYS (100000)
+#define TOTEM_BENCH_KEYSIZE (128)
+#define TOTEM_BENCH_ROUNDS (50)
+
+// mirrors TOTEM_HASHMAP_H1 / H2 & the widest group size in memory.c
+#define TOTEM_BENCH_H1(hash) ((size_t)((hash) >> 7))
+#define TOTEM_BENCH_H2(hash) ((size_t)((hash) & 0x7F))
+#define TOTEM_BENCH_NUMH2 (128)
+#define TOTEM_BENCH_GROUPWIDTH (16)
+
+typedef totemHash(*totemBenchHashCb)(const void*, size_t);
+
+typedef struct
+{
+    char Keys[TOTEM_BENCH_NUMKEYS][TOTEM_BENCH_KEYSIZE];
+    size_t Lengths[TOTEM_BENCH_NUMKEYS];
+    size_t NumBytes;
+}
+totemBenchKeySet;
+
+static totemHash totemBench_OldHash(const void *data, size_t len)
+{
+    const char *ptr = data;
+    
+    totemHash hash = 5831;
+    for(uint32_t i = 0; i < len; ++i)
+    {
+        hash = 33 * hash + ptr[i];
+    }
+    
+    return hash;
+}
+
+static void totemBench_AddKey(totemBenchKeySet *set, size_t i, int len)
+{
+    set->Lengths[i] = (size_t)len;
+    set->NumBytes += (size_t)len;
+}
+
+static void totemBench_MakeIdentifiers(totemBenchKeySet *set)
+{
+    static const char *words[] = { "get", "set", "user", "name", "id", "count", "index", "value", "node", "next", "prev", "item" };
+    size_t numWords = TOTEM_ARRAY_SIZE(words);
+    
+    set->NumBytes = 0;
+    for (size_t i = 0; i < TOTEM_BENCH_NUMKEYS; i++)
+    {
+        int len = totem_snprintf(set->Keys[i], TOTEM_BENCH_KEYSIZE, "%s%s%s%u",
+                                 words[i % numWords],
+                                 words[(i / numWords) % numWords],
+                                 words[(i / (numWords * numWords)) % numWords],
+                                 (unsigned)(i / (numWords * numWords * numWords)));
+        totemBench_AddKey(set, i, len);
+    }
+}
+
+static void totemBench_MakeUrls(totemBenchKeySet *set)
+{
+    set->NumBytes = 0;
+    for (size_t i = 0; i < TOTEM_BENCH_NUMKEYS; i++)
+    {
+        int len = totem_snprintf(set->Keys[i], TOTEM_BENCH_KEYSIZE, "https://api.example.com/v2/accounts/%u/documents/%u?session=%08x&format=json",
+                                 (unsigned)(i / 100),
+                                 (unsigned)(i % 100),
+                                 (unsigned)(i * 2654435761u));
+        totemBench_AddKey(set, i, len);
+    }
+}
+
+static void totemBench_Throughput(const char *name, totemBenchHashCb hash, totemBenchKeySet *set)
+{
+    volatile totemHash sink = 0;
+    clock_t start = clock();
+    
+    for (size_t r = 0; r < TOTEM_BENCH_ROUNDS; r++)
+    {
+        for (size_t i = 0; i < TOTEM_BENCH_NUMKEYS; i++)
+        {
+            sink ^= hash(set->Keys[i], set->Lengths[i]);
+        }
+    }
+    
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    double numKeys = (double)TOTEM_BENCH_NUMKEYS * TOTEM_BENCH_ROUNDS;
+    double numBytes = (double)set->NumBytes * TOTEM_BENCH_ROUNDS;
+    
+    printf("  %-8s %8.2f ns/key %10.1f MB/s\n", name, (seconds * 1e9) / numKeys, (numBytes / (1024 * 1024)) / seconds);
+}
+
+// chi-squared against a uniform spread, per degree of freedom - close to 1.0 is ideal
+static double totemBench_ChiSquared(size_t *counts, size_t numCounts, size_t total)
+{
+    double expected = (double)total / numCounts;
+    double chi = 0;
+    
+    for (size_t i = 0; i < numCounts; i++)
+    {
+        double d = counts[i] - expected;
+        chi += (d * d) / expected;
+    }
+    
+    return chi / (numCounts - 1);
+}
+
+// capacity must be a power of two, as it is in the table
+static void totemBench_Distribution(const char *name, totemBenchHashCb hash, totemBenchKeySet *set, size_t capacity)
+{
+    size_t numGroups = capacity / TOTEM_BENCH_GROUPWIDTH;
+    size_t *slots = calloc(capacity, sizeof(size_t));
+    size_t *groupTags = calloc(numGroups * TOTEM_BENCH_NUMH2, sizeof(size_t));
+    if (!slots || !groupTags)
+    {
+        free(slots);
+        free(groupTags);
+        return;
+    }
+    
+    for (size_t i = 0; i < TOTEM_BENCH_NUMKEYS; i++)
+    {
+        totemHash h = hash(set->Keys[i], set->Lengths[i]);
+        size_t slot = TOTEM_BENCH_H1(h) & (capacity - 1);
+        slots[slot]++;
+        groupTags[((slot / TOTEM_BENCH_GROUPWIDTH) * TOTEM_BENCH_NUMH2) + TOTEM_BENCH_H2(h)]++;
+    }
+    
+    size_t longest = 0;
+    size_t empty = 0;
+    
+    for (size_t i = 0; i < capacity; i++)
+    {
+        if (slots[i] > longest)
+        {
+            longest = slots[i];
+        }
+        
+        if (!slots[i])
+        {
+            empty++;
+        }
+    }
+    
+    // other keys starting in the same group with the same control byte, each costing a wasted key compare
+    double falseMatches = 0;
+    for (size_t i = 0; i < numGroups * TOTEM_BENCH_NUMH2; i++)
+    {
+        falseMatches += (double)groupTags[i] * (groupTags[i] ? groupTags[i] - 1 : 0);
+    }
+    
+    double expected = (double)TOTEM_BENCH_NUMKEYS / capacity;
+    double perGroup = (double)TOTEM_BENCH_NUMKEYS / numGroups;
+    
+    printf("  %-8s %7zu slots  h1 chi2/dof %8.3f  longest %4zu  empty %5.1f%% (uniform %5.1f%%)  h2 false matches/key %6.3f (uniform %6.3f)\n",
+           name,
+           capacity,
+           totemBench_ChiSquared(slots, capacity, TOTEM_BENCH_NUMKEYS),
+           longest,
+           100.0 * empty / capacity,
+           100.0 * exp(-expected),
+           falseMatches / TOTEM_BENCH_NUMKEYS,
+           perGroup / TOTEM_BENCH_NUMH2);
+    
+    free(slots);
+    free(groupTags);
+}
+
+static void totemBench_ControlBytes(const char *name, totemBenchHashCb hash, totemBenchKeySet *set)
+{
+    size_t tags[TOTEM_BENCH_NUMH2];
+    memset(tags, 0, sizeof(tags));
+    
+    for (size_t i = 0; i < TOTEM_BENCH_NUMKEYS; i++)
+    {
+        tags[TOTEM_BENCH_H2(hash(set->Keys[i], set->Lengths[i]))]++;
+    }
+    
+    printf("  %-8s h2 chi2/dof %8.3f\n", name, totemBench_ChiSquared(tags, TOTEM_BENCH_NUMH2, TOTEM_BENCH_NUMKEYS));
+}
+
+static void totemBench_Run(const char *title, totemBenchKeySet *set)
+{
+    printf("%s (%d keys, %.1f bytes avg)\n", title, TOTEM_BENCH_NUMKEYS, (double)set->NumBytes / TOTEM_BENCH_NUMKEYS);
+    
+    totemBench_Throughput("old", totemBench_OldHash, set);
+    totemBench_Throughput("default", totem_DefaultHash, set);
+    
+    totemBench_ControlBytes("old", totemBench_OldHash, set);
+    totemBench_ControlBytes("default", totem_DefaultHash, set);
+    
+    // the table grows at 7/8ths full, so 100k keys live in a 128k or 256k table
+    size_t sizes[] = { 131072, 262144 };
+    for (size_t i = 0; i < TOTEM_ARRAY_SIZE(sizes); i++)
+    {
+        totemBench_Distribution("old", totemBench_OldHash, set, sizes[i]);
+        totemBench_Distribution("default", totem_DefaultHash, set, sizes[i]);
+    }
+    
+    printf("\n");
+}
+
+int main(int argc, const char * argv[])
+{
+    totemBenchKeySet *set = malloc(sizeof(totemBenchKeySet));
+    if (!set)
+    {
+        return 1;
+    }
+    
+    totemBench_MakeIdentifiers(set);
+    totemBench_Run("identifiers", set);
+    
+    totemBench_MakeUrls(set);
+    totemBench_Run("urls", set);
+    
+    free(set);
+    return 0;
+}